@@ -0,0 +1,55 @@
+#include "batch.h"
+
+#include <atomic>
+
+namespace flow
+{
+    BatchParser::BatchParser(unsigned a_Threads) : m_Pool(a_Threads)
+    {
+        for(unsigned i = 0; i < m_Pool.Size(); ++i) {
+            m_Workers.emplace_back(new Worker);
+        }
+    }
+
+    bool BatchParser::ParseBatch(const std::vector<BatchItem> & a_Items, std::vector<BatchResult> & a_Results)
+    {
+        a_Results.clear();
+        a_Results.resize(a_Items.size());
+        std::atomic<bool> success(true);
+        m_Pool.ForEach(a_Items.size(), [&](size_t a_Index, unsigned a_Worker) {
+            ParseItem(a_Items[a_Index], a_Results[a_Index], *m_Workers[a_Worker]);
+            if (!a_Results[a_Index].Success) {
+                success = false;
+            }
+        });
+        return success;
+    }
+
+    void BatchParser::ParseItem(const BatchItem & a_Item, BatchResult & a_Result, Worker & a_Worker)
+    {
+        if (a_Item.Path) {
+            a_Result.Success = a_Worker.Parser.ParseFile(a_Item.Path, a_Result.Document);
+        } else {
+            a_Result.Success = a_Worker.Parser.Parse(a_Item.Data, a_Item.Size, a_Result.Document);
+        }
+        if (!a_Result.Success) {
+            a_Result.ErrorString = a_Worker.Parser.GetErrorString();
+        }
+
+        /** the worker's symbols are append only, so only the new ones need to be mapped */
+        const flow::SymbolTable & table = a_Worker.Parser.GetSymbolTable();
+        for(size_t i = a_Worker.Map.size(); i < table.Size(); ++i) {
+            SymbolTable::SymIndex index = static_cast<SymbolTable::SymIndex>(i);
+            SymbolTable::SymIndex shared = m_SymbolTable.Insert(table.Retrive(index), table.Length(index));
+            if (shared == SymbolTable::InvalidIndex) {
+                /** the rest of the names stay unmapped and are tried again with the next item */
+                a_Result.Document.Clear();
+                a_Result.Success        = false;
+                a_Result.ErrorString    = "OUT OF MEMORY";
+                return;
+            }
+            a_Worker.Map.push_back(shared);
+        }
+        RemapNames(a_Result.Document, a_Worker.Map);
+    }
+}
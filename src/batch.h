@@ -0,0 +1,88 @@
+#ifndef _FLOW_BATCH_H_
+#define _FLOW_BATCH_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "concurrent_symbol_table.h"
+#include "parser.h"
+#include "thread_pool.h"
+
+namespace flow
+{
+    /**
+     * \brief   A document to parse in a batch, either a file or a buffer.
+     */
+    struct BatchItem
+    {
+        explicit BatchItem(const char * a_Path) : Path(a_Path), Data(nullptr), Size(0)
+        {
+        }
+
+        BatchItem(const char * a_Data, size_t a_Size) : Path(nullptr), Data(a_Data), Size(a_Size)
+        {
+        }
+
+        const char *    Path;   /**< File to memory map and parse, or nullptr to parse Data */
+        const char *    Data;
+        size_t          Size;
+    };
+
+    struct BatchResult
+    {
+        BatchResult() : Success(false)
+        {
+        }
+
+        FlowDocument    Document;       /**< Names refer to the batch parser's symbol table, empty if they couldn't be added to it */
+        bool            Success;
+        std::string     ErrorString;    /**< Only set if Success is false */
+    };
+
+    /**
+     * \brief   Parses many documents concurrently into one shared name space.
+     *
+     * Every worker thread keeps a Parser of its own that is reused for all the documents 
+     * it parses, along with a mapping from the names in that parser's symbol table to the
+     * shared table. Once the common names are known a worker only touches the shared 
+     * table for names it has never seen before.
+     */
+    class BatchParser
+    {
+    public:
+        /**
+         * \param   a_Threads   Number of worker threads, 0 uses one per hardware thread.
+         */
+        explicit BatchParser(unsigned a_Threads = 0);
+
+        /**
+         * \brief   Parses every item, a_Results receives one result per item in the same order.
+         *
+         * \return  true if every item was parsed successfully, or false otherwise.
+         */
+        bool ParseBatch(const std::vector<BatchItem> & a_Items, std::vector<BatchResult> & a_Results);
+        /**
+         * \brief   Returns the name of a symbol in any of the documents parsed by this batch parser.
+         */
+        const char * GetString(SymbolTable::SymIndex a_Index) const     {return m_SymbolTable.Retrive(a_Index);}
+        const ConcurrentSymbolTable & GetSymbolTable() const            {return m_SymbolTable;}
+
+    protected:
+        BatchParser(const BatchParser &);
+        BatchParser & operator=(const BatchParser &);
+
+        struct Worker {
+            flow::Parser                        Parser;
+            std::vector<SymbolTable::SymIndex>  Map;    /**< From the worker parser's symbols to the shared ones */
+        };
+
+        void ParseItem(const BatchItem & a_Item, BatchResult & a_Result, Worker & a_Worker);
+
+        ConcurrentSymbolTable                   m_SymbolTable;
+        ThreadPool                              m_Pool;
+        std::vector<std::unique_ptr<Worker>>    m_Workers;
+    };
+}
+
+#endif
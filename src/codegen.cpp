@@ -0,0 +1,200 @@
+#include "codegen.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <initializer_list>
+#include <sstream>
+#include <unordered_set>
+
+namespace flow
+{
+    /** Names that can't be used as identifiers in C++ */
+    static const char * const CppKeywords[] = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+        "case", "catch", "char", "char16_t", "char32_t", "class", "compl", "const", "const_cast",
+        "constexpr", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+        "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+        "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+        "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert",
+        "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+        "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+        "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+
+    CodeGenerator::CodeGenerator()
+    {
+    }
+
+    /**
+     * \brief   Returns true if a name can't be used because it is a C++ keyword or one of the 
+     *          names the generated code already uses in that scope.
+     */
+    static bool IsReserved(const char * a_Name, std::initializer_list<const char *> a_Taken)
+    {
+        for(const char * keyword : CppKeywords) {
+            if (strcmp(keyword, a_Name) == 0) {
+                return true;
+            }
+        }
+        for(const char * taken : a_Taken) {
+            if (strcmp(taken, a_Name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool CodeGenerator::Reserved(const char * a_Name, const char * a_Definition)
+    {
+        m_ErrorString = std::string("RESERVED NAME ") + a_Name + (a_Definition ? std::string(" IN ") + a_Definition : std::string());
+        return false;
+    }
+
+    /**
+     * \brief   Formats a float as a literal that converts back to the same value.
+     */
+    static std::string FloatLiteral(float a_Value)
+    {
+        char buffer[32];
+        std::to_chars_result res = std::to_chars(buffer, buffer + sizeof(buffer), a_Value);
+        std::string literal(buffer, res.ptr);
+        if (literal.find_first_of(".e") == std::string::npos) {
+            literal += ".0";
+        }
+        return literal + "f";
+    }
+
+    template<class Definition>
+    bool CodeGenerator::WriteDefinition(const Definition & a_Definition, bool a_IsQuery, const SymbolTable & a_Symbols, std::ostream & a_Stream)
+    {
+        const char * name = a_Symbols.Retrive(a_Definition.NameIndex);
+        /** indented when inside a namespace */
+        std::string indent = m_Namespace.empty() ? "" : "    ";
+        /** events and variables share one namespace per definition, as in a DocumentIndex,
+            so a document is accepted here exactly when a Runtime can load it */
+        std::unordered_set<SymbolTable::SymIndex> members;
+        for(const FlowEvent & ev : a_Definition.Events) {
+            if (IsReserved(a_Symbols.Retrive(ev.NameIndex), {"Count"})) {
+                return Reserved(a_Symbols.Retrive(ev.NameIndex), name);
+            }
+            if (!members.insert(ev.NameIndex).second) {
+                m_ErrorString = std::string("DUPLICATE MEMBER ") + a_Symbols.Retrive(ev.NameIndex) + " IN " + name;
+                return false;
+            }
+        }
+        /** the enums are members of the struct, and no member can be named as the struct */
+        for(const FlowVariable & variable : a_Definition.Variables) {
+            if (IsReserved(a_Symbols.Retrive(variable.NameIndex), {"InEvent", "OutEvent", name})) {
+                return Reserved(a_Symbols.Retrive(variable.NameIndex), name);
+            }
+            if (!members.insert(variable.NameIndex).second) {
+                m_ErrorString = std::string("DUPLICATE MEMBER ") + a_Symbols.Retrive(variable.NameIndex) + " IN " + name;
+                return false;
+            }
+        }
+
+        a_Stream << "\n" << indent << "/** " << (a_IsQuery ? "query " : "node ") << name << " */\n";
+        a_Stream << indent << "struct " << name << "\n" << indent << "{\n";
+        /** queries only have output events */
+        for(int direction = a_IsQuery ? FlowEvent::EVENT_OUT : FlowEvent::EVENT_IN; direction <= FlowEvent::EVENT_OUT; ++direction) {
+            a_Stream << indent << "    enum class " << ((direction == FlowEvent::EVENT_IN) ? "InEvent" : "OutEvent") << " : ::std::uint32_t {\n";
+            for(const FlowEvent & ev : a_Definition.Events) {
+                if (ev.Direction == direction) {
+                    a_Stream << indent << "        " << a_Symbols.Retrive(ev.NameIndex) << ",\n";
+                }
+            }
+            a_Stream << indent << "        Count\n" << indent << "    };\n";
+        }
+
+        size_t floats = 0, bools = 0;
+        for(int type = FlowVariable::TYPE_FLOAT; type >= FlowVariable::TYPE_BOOL; --type) {
+            for(const FlowVariable & variable : a_Definition.Variables) {
+                if (variable.Type != type) {
+                    continue;
+                }
+                a_Stream << ((floats + bools == 0) ? "\n" : "");
+                a_Stream << indent << "    " << ((type == FlowVariable::TYPE_FLOAT) ? "float   " : "bool    ") << a_Symbols.Retrive(variable.NameIndex) << " = ";
+                if (type == FlowVariable::TYPE_FLOAT) {
+                    a_Stream << FloatLiteral(variable.HasDefaultValue ? variable.DefaultValue.fValue : 0.0f) << ";";
+                    ++floats;
+                } else {
+                    a_Stream << ((variable.HasDefaultValue && variable.DefaultValue.bValue) ? "true" : "false") << ";";
+                    ++bools;
+                }
+                if (variable.HasDirection) {
+                    a_Stream << "  /**< " << ((variable.Direction == FlowEvent::EVENT_IN) ? "in" : "out") << " */";
+                }
+                a_Stream << "\n";
+            }
+        }
+        a_Stream << indent << "};\n";
+
+        /** no padding but the tail, and copyable as bytes */
+        size_t size = floats * sizeof(float) + bools * sizeof(bool);
+        size = floats ? ((size + alignof(float) - 1) & ~(alignof(float) - 1)) : (size ? size : 1);
+        a_Stream << indent << "static_assert(sizeof(" << name << ") == " << size << ", \"" << name << " must be tightly packed\");\n";
+        a_Stream << indent << "static_assert(::std::is_standard_layout<" << name << ">::value && ::std::is_trivially_copyable<" << name
+                 << ">::value, \"" << name << " must be plain data\");\n";
+        return true;
+    }
+
+    bool CodeGenerator::Generate(const FlowDocument & a_Document, const SymbolTable & a_Symbols, std::ostream & a_Stream)
+    {
+        m_ErrorString = "";
+        std::string guard = m_Guard;
+        if (guard.empty()) {
+            std::string name = m_SourceName.substr(m_SourceName.find_last_of("/\\") + 1);
+            guard = "_";
+            for(char c : name.empty() ? std::string("flow") : name) {
+                guard += ((c >= 'a') && (c <= 'z')) ? static_cast<char>(c - 'a' + 'A') : (isalnum(static_cast<unsigned char>(c)) ? c : '_');
+            }
+            guard += "_H_";
+        }
+
+        /** the generated code refers to ::std, which a struct named std would hide, and a
+            struct can't have a member enum with its own name */
+        std::unordered_set<SymbolTable::SymIndex> definitions;
+        for(size_t i = 0; i < a_Document.Nodes.size() + a_Document.Queries.size(); ++i) {
+            SymbolTable::SymIndex name = (i < a_Document.Nodes.size()) ? a_Document.Nodes[i].NameIndex : a_Document.Queries[i - a_Document.Nodes.size()].NameIndex;
+            if (IsReserved(a_Symbols.Retrive(name), {"std", "InEvent", "OutEvent"})) {
+                return Reserved(a_Symbols.Retrive(name), nullptr);
+            }
+            if (!definitions.insert(name).second) {
+                m_ErrorString = std::string("DUPLICATE DEFINITION ") + a_Symbols.Retrive(name);
+                return false;
+            }
+        }
+
+        /** the header is only written once every definition has been checked */
+        std::ostringstream out;
+        out << "/** Generated from " << (m_SourceName.empty() ? "a flow document" : m_SourceName) << ", do not edit */\n";
+        out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+        out << "#include <cstdint>\n#include <type_traits>\n";
+        if (!m_Namespace.empty()) {
+            out << "\nnamespace " << m_Namespace << "\n{";
+        }
+        for(const FlowNode & node : a_Document.Nodes) {
+            if (!WriteDefinition(node, false, a_Symbols, out)) {
+                return false;
+            }
+        }
+        for(const FlowQuery & query : a_Document.Queries) {
+            if (!WriteDefinition(query, true, a_Symbols, out)) {
+                return false;
+            }
+        }
+        if (!m_Namespace.empty()) {
+            out << "}\n";
+        }
+        out << "\n#endif\n";
+
+        a_Stream << out.str();
+        if (!a_Stream) {
+            m_ErrorString = "FAILED TO WRITE";
+            return false;
+        }
+        return true;
+    }
+}
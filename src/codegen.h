@@ -0,0 +1,57 @@
+#ifndef _FLOW_CODEGEN_H_
+#define _FLOW_CODEGEN_H_
+
+#include <ostream>
+#include <string>
+
+#include "parser.h"
+
+namespace flow
+{
+    /**
+     * \brief   Writes a C++ header with a struct for every node and query of a document.
+     *
+     * Each struct holds the variables of the definition as typed fields, initialized to
+     * their default values, with the floats before the bools so that no padding is needed
+     * between them. The events are listed in the InEvent and OutEvent enums of the struct,
+     * each ending with Count. Game code can then keep the state of a node in a plain struct
+     * and switch over its events, without looking anything up by name.
+     */
+    class CodeGenerator
+    {
+    public:
+        CodeGenerator();
+
+        /** Namespace of the generated structs, the global namespace if empty */
+        void SetNamespace(const std::string & a_Namespace)      {m_Namespace = a_Namespace;}
+        /** Include guard of the generated header, derived from the source name if empty */
+        void SetIncludeGuard(const std::string & a_Guard)       {m_Guard = a_Guard;}
+        /** Name of the document, mentioned in the header */
+        void SetSourceName(const std::string & a_Name)          {m_SourceName = a_Name;}
+
+        /**
+         * \brief   Writes the header for a document.
+         * \param   a_Symbols   The symbol table the document was parsed with.
+         * \return  false if a name can't be used in C++ or is used twice, nothing is written then.
+         */
+        bool Generate(const FlowDocument & a_Document, const SymbolTable & a_Symbols, std::ostream & a_Stream);
+
+        const std::string & GetErrorString() const              {return m_ErrorString;}
+
+    protected:
+        CodeGenerator(const CodeGenerator &);
+        CodeGenerator & operator=(const CodeGenerator &);
+
+        template<class Definition>
+        bool        WriteDefinition(const Definition & a_Definition, bool a_IsQuery, const SymbolTable & a_Symbols, std::ostream & a_Stream);
+        /** Reports a reserved name, always returns false */
+        bool        Reserved(const char * a_Name, const char * a_Definition);
+
+        std::string     m_Namespace;
+        std::string     m_Guard;
+        std::string     m_SourceName;
+        std::string     m_ErrorString;
+    };
+}
+
+#endif
@@ -0,0 +1,312 @@
+#include "compiled.h"
+
+#include <cstring>
+
+namespace flow
+{
+    static const uint32_t InvalidName = 0xffffffffu;
+
+    /**
+     * \brief   Gives every name used by the document a dense index in the blob's own name table.
+     */
+    template<class Names>
+    class NameCollector
+    {
+    public:
+        NameCollector(const Names & a_Names) : m_Names(a_Names), m_Map(a_Names.Size(), InvalidName), m_nStringSize(0)
+        {
+        }
+
+        bool Add(SymbolTable::SymIndex a_Index, uint32_t & a_Name)
+        {
+            if (a_Index >= m_Map.size()) {
+                return false;
+            }
+            if (m_Map[a_Index] == InvalidName) {
+                if (!m_Names.Retrive(a_Index)) {
+                    return false;
+                }
+                m_Map[a_Index] = static_cast<uint32_t>(m_Symbols.size());
+                m_Symbols.push_back(a_Index);
+                m_nStringSize += m_Names.Length(a_Index) + 1;
+            }
+            a_Name = m_Map[a_Index];
+            return true;
+        }
+
+        const std::vector<SymbolTable::SymIndex> &  Symbols() const     {return m_Symbols;}
+        size_t                                      StringSize() const  {return m_nStringSize;}
+        const Names &                               Table() const       {return m_Names;}
+
+    protected:
+        const Names &                       m_Names;
+        std::vector<uint32_t>               m_Map;      /**< From symbol index to name index */
+        std::vector<SymbolTable::SymIndex>  m_Symbols;  /**< From name index to symbol index */
+        size_t                              m_nStringSize;
+    };
+
+    template<class Names>
+    static bool CompileEvents(const FlowEventList & a_Events, NameCollector<Names> & a_Names, std::vector<CompiledEvent> & a_Out)
+    {
+        for(const FlowEvent & ev : a_Events) {
+            CompiledEvent compiled = {};
+            if (!a_Names.Add(ev.NameIndex, compiled.Name)) {
+                return false;
+            }
+            compiled.Direction = static_cast<uint8_t>(ev.Direction);
+            a_Out.push_back(compiled);
+        }
+        return true;
+    }
+
+    template<class Names>
+    static bool CompileVariables(const FlowVariableList & a_Variables, NameCollector<Names> & a_Names, std::vector<CompiledVariable> & a_Out)
+    {
+        for(const FlowVariable & var : a_Variables) {
+            CompiledVariable compiled = {};
+            if (!a_Names.Add(var.NameIndex, compiled.Name)) {
+                return false;
+            }
+            compiled.Type = static_cast<uint8_t>(var.Type);
+            if (var.HasDirection) {
+                compiled.Flags      |= CompiledVariable::HAS_DIRECTION;
+                compiled.Direction  = static_cast<uint8_t>(var.Direction);
+            }
+            if (var.HasDefaultValue) {
+                compiled.Flags |= CompiledVariable::HAS_DEFAULT_VALUE;
+                if (var.Type == FlowVariable::TYPE_FLOAT) {
+                    compiled.DefaultValue.fValue = var.DefaultValue.fValue;
+                } else {
+                    compiled.DefaultValue.bValue = var.DefaultValue.bValue ? 1 : 0;
+                }
+            }
+            a_Out.push_back(compiled);
+        }
+        return true;
+    }
+
+    template<class Definition, class Names>
+    static bool CompileDefinition(const Definition & a_Definition, NameCollector<Names> & a_Names, 
+        std::vector<CompiledDefinition> & a_Definitions, std::vector<CompiledEvent> & a_Events, std::vector<CompiledVariable> & a_Variables)
+    {
+        CompiledDefinition compiled = {};
+        if (!a_Names.Add(a_Definition.NameIndex, compiled.Name)) {
+            return false;
+        }
+        compiled.FirstEvent     = static_cast<uint32_t>(a_Events.size());
+        compiled.EventCount     = static_cast<uint32_t>(a_Definition.Events.size());
+        compiled.FirstVariable  = static_cast<uint32_t>(a_Variables.size());
+        compiled.VariableCount  = static_cast<uint32_t>(a_Definition.Variables.size());
+        if (!CompileEvents(a_Definition.Events, a_Names, a_Events) || !CompileVariables(a_Definition.Variables, a_Names, a_Variables)) {
+            return false;
+        }
+        a_Definitions.push_back(compiled);
+        return true;
+    }
+
+    template<class T>
+    static void Append(std::vector<char> & a_Blob, size_t a_Offset, const std::vector<T> & a_Items)
+    {
+        if (!a_Items.empty()) {
+            memcpy(&a_Blob[a_Offset], a_Items.data(), a_Items.size() * sizeof(T));
+        }
+    }
+
+    template<class Names>
+    static bool Compile(const FlowDocument & a_Document, const Names & a_Table, std::vector<char> & a_Blob)
+    {
+        NameCollector<Names>            names(a_Table);
+        std::vector<CompiledDefinition> definitions;
+        std::vector<CompiledEvent>      events;
+        std::vector<CompiledVariable>   variables;
+
+        definitions.reserve(a_Document.Nodes.size() + a_Document.Queries.size());
+        for(const FlowNode & node : a_Document.Nodes) {
+            if (!CompileDefinition(node, names, definitions, events, variables)) {
+                return false;
+            }
+        }
+        for(const FlowQuery & query : a_Document.Queries) {
+            if (!CompileDefinition(query, names, definitions, events, variables)) {
+                return false;
+            }
+        }
+
+        /** every section is a multiple of 4 bytes, so all of them stay aligned */
+        CompiledHeader header = {};
+        header.Magic            = CompiledMagic;
+        header.Version          = CompiledFormatVersion;
+        header.NodeCount        = static_cast<uint32_t>(a_Document.Nodes.size());
+        header.QueryCount       = static_cast<uint32_t>(a_Document.Queries.size());
+        header.EventCount       = static_cast<uint32_t>(events.size());
+        header.VariableCount    = static_cast<uint32_t>(variables.size());
+        header.NameCount        = static_cast<uint32_t>(names.Symbols().size());
+
+        uint64_t offset = sizeof(CompiledHeader);
+        header.DefinitionOffset = static_cast<uint32_t>(offset);
+        offset += definitions.size() * sizeof(CompiledDefinition);
+        header.EventOffset      = static_cast<uint32_t>(offset);
+        offset += events.size() * sizeof(CompiledEvent);
+        header.VariableOffset   = static_cast<uint32_t>(offset);
+        offset += variables.size() * sizeof(CompiledVariable);
+        header.NameOffset       = static_cast<uint32_t>(offset);
+        offset += names.Symbols().size() * sizeof(uint32_t);
+        header.StringOffset     = static_cast<uint32_t>(offset);
+        header.StringSize       = static_cast<uint32_t>((names.StringSize() + 3) & ~static_cast<size_t>(3));
+        offset += header.StringSize;
+        if (offset > 0xffffffffu) {
+            return false;
+        }
+        header.Size = static_cast<uint32_t>(offset);
+
+        a_Blob.assign(header.Size, 0);
+        memcpy(&a_Blob[0], &header, sizeof(header));
+        Append(a_Blob, header.DefinitionOffset, definitions);
+        Append(a_Blob, header.EventOffset, events);
+        Append(a_Blob, header.VariableOffset, variables);
+
+        uint32_t stringOffset = 0;
+        for(size_t i = 0; i < names.Symbols().size(); ++i) {
+            SymbolTable::SymIndex symbol = names.Symbols()[i];
+            size_t length = a_Table.Length(symbol);
+            memcpy(&a_Blob[header.NameOffset + i * sizeof(uint32_t)], &stringOffset, sizeof(stringOffset));
+            memcpy(&a_Blob[header.StringOffset + stringOffset], a_Table.Retrive(symbol), length);
+            stringOffset += static_cast<uint32_t>(length + 1);
+        }
+        return true;
+    }
+
+    bool CompileDocument(const FlowDocument & a_Document, const SymbolTable & a_Names, std::vector<char> & a_Blob)
+    {
+        return Compile(a_Document, a_Names, a_Blob);
+    }
+
+    bool CompileDocument(const FlowDocument & a_Document, const ConcurrentSymbolTable & a_Names, std::vector<char> & a_Blob)
+    {
+        return Compile(a_Document, a_Names, a_Blob);
+    }
+
+    CompiledDocument::CompiledDocument() : 
+        m_pHeader(nullptr), m_pDefinitions(nullptr), m_pEvents(nullptr), m_pVariables(nullptr), m_pNames(nullptr), m_pStrings(nullptr)
+    {
+    }
+
+    bool CompiledDocument::Fail(const char * a_Error)
+    {
+        m_pHeader       = nullptr;
+        m_ErrorString   = a_Error;
+        return false;
+    }
+
+    /**
+     * \brief   Checks that a section of a_Count items lies within the blob and is aligned.
+     */
+    static bool SectionFits(const CompiledHeader & a_Header, uint32_t a_Offset, uint32_t a_Count, size_t a_ItemSize)
+    {
+        uint64_t end = static_cast<uint64_t>(a_Offset) + static_cast<uint64_t>(a_Count) * a_ItemSize;
+        return (a_Offset >= sizeof(CompiledHeader)) && ((a_Offset & 3) == 0) && (end <= a_Header.Size);
+    }
+
+    bool CompiledDocument::Load(const void * a_Data, size_t a_Size)
+    {
+        m_pHeader = nullptr;
+        m_ErrorString = "";
+        if (!a_Data || (a_Size < sizeof(CompiledHeader)) || ((reinterpret_cast<size_t>(a_Data) & 3) != 0)) {
+            return Fail("INVALID BLOB");
+        }
+        const CompiledHeader * pHeader = static_cast<const CompiledHeader *>(a_Data);
+        if (pHeader->Magic != CompiledMagic) {
+            return Fail("NOT A COMPILED FLOW DOCUMENT");
+        }
+        if (pHeader->Version != CompiledFormatVersion) {
+            return Fail("UNSUPPORTED FORMAT VERSION");
+        }
+        if ((pHeader->Size > a_Size) || 
+            !SectionFits(*pHeader, pHeader->DefinitionOffset, pHeader->NodeCount + pHeader->QueryCount, sizeof(CompiledDefinition)) ||
+            (pHeader->NodeCount + pHeader->QueryCount < pHeader->NodeCount) ||
+            !SectionFits(*pHeader, pHeader->EventOffset, pHeader->EventCount, sizeof(CompiledEvent)) ||
+            !SectionFits(*pHeader, pHeader->VariableOffset, pHeader->VariableCount, sizeof(CompiledVariable)) ||
+            !SectionFits(*pHeader, pHeader->NameOffset, pHeader->NameCount, sizeof(uint32_t)) ||
+            !SectionFits(*pHeader, pHeader->StringOffset, pHeader->StringSize, 1)) {
+            return Fail("CORRUPT SECTION TABLE");
+        }
+
+        const char * base = static_cast<const char *>(a_Data);
+        const CompiledDefinition * pDefinitions = reinterpret_cast<const CompiledDefinition *>(base + pHeader->DefinitionOffset);
+        const CompiledEvent * pEvents           = reinterpret_cast<const CompiledEvent *>(base + pHeader->EventOffset);
+        const CompiledVariable * pVariables     = reinterpret_cast<const CompiledVariable *>(base + pHeader->VariableOffset);
+        const uint32_t * pNames                 = reinterpret_cast<const uint32_t *>(base + pHeader->NameOffset);
+        const char * pStrings                   = base + pHeader->StringOffset;
+
+        /** every reference is checked once here, so the accessors don't have to */
+        if ((pHeader->StringSize > 0) && (pStrings[pHeader->StringSize - 1] != 0)) {
+            return Fail("UNTERMINATED STRING TABLE");
+        }
+        for(uint32_t i = 0; i < pHeader->NameCount; ++i) {
+            if (pNames[i] >= pHeader->StringSize) {
+                return Fail("CORRUPT NAME TABLE");
+            }
+        }
+        for(uint32_t i = 0; i < pHeader->NodeCount + pHeader->QueryCount; ++i) {
+            const CompiledDefinition & def = pDefinitions[i];
+            if ((def.Name >= pHeader->NameCount) || 
+                (static_cast<uint64_t>(def.FirstEvent) + def.EventCount > pHeader->EventCount) ||
+                (static_cast<uint64_t>(def.FirstVariable) + def.VariableCount > pHeader->VariableCount)) {
+                return Fail("CORRUPT DEFINITION");
+            }
+        }
+        for(uint32_t i = 0; i < pHeader->EventCount; ++i) {
+            if ((pEvents[i].Name >= pHeader->NameCount) || (pEvents[i].Direction > FlowEvent::EVENT_OUT)) {
+                return Fail("CORRUPT EVENT");
+            }
+        }
+        for(uint32_t i = 0; i < pHeader->VariableCount; ++i) {
+            const CompiledVariable & var = pVariables[i];
+            if ((var.Name >= pHeader->NameCount) || (var.Type > FlowVariable::TYPE_FLOAT) || 
+                ((var.Flags & ~(CompiledVariable::HAS_DEFAULT_VALUE | CompiledVariable::HAS_DIRECTION)) != 0) ||
+                (var.Direction > FlowEvent::EVENT_OUT) ||
+                ((var.Type == FlowVariable::TYPE_BOOL) && (var.DefaultValue.bValue > 1))) {
+                return Fail("CORRUPT VARIABLE");
+            }
+        }
+
+        m_pHeader       = pHeader;
+        m_pDefinitions  = pDefinitions;
+        m_pEvents       = pEvents;
+        m_pVariables    = pVariables;
+        m_pNames        = pNames;
+        m_pStrings      = pStrings;
+        return true;
+    }
+
+    bool CompiledDocument::LoadFile(const char * a_Path)
+    {
+        Close();
+        if (!m_File.Open(a_Path)) {
+            return Fail("FAILED TO OPEN FILE");
+        }
+        if (!Load(m_File.Data(), m_File.Size())) {
+            m_File.Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool CompiledDocument::LoadBlob(std::vector<char> && a_Blob)
+    {
+        Close();
+        m_Blob.swap(a_Blob);
+        if (!Load(m_Blob.data(), m_Blob.size())) {
+            m_Blob.clear();
+            return false;
+        }
+        return true;
+    }
+
+    void CompiledDocument::Close()
+    {
+        m_pHeader = nullptr;
+        m_File.Close();
+        m_Blob.clear();
+    }
+}
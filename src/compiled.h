@@ -0,0 +1,135 @@
+#ifndef _FLOW_COMPILED_H_
+#define _FLOW_COMPILED_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "concurrent_symbol_table.h"
+#include "mapped_file.h"
+#include "parser.h"
+
+namespace flow
+{
+    /**
+     * The compiled format is a single position independent blob, every reference is an 
+     * offset from the start of the blob or an index into one of its arrays:
+     *
+     *  CompiledHeader
+     *  CompiledDefinition[NodeCount]       nodes followed by
+     *  CompiledDefinition[QueryCount]      queries
+     *  CompiledEvent[EventCount]           events of all definitions, each definition owns a range
+     *  CompiledVariable[VariableCount]     variables of all definitions, each definition owns a range
+     *  uint32_t[NameCount]                 offset of each name in the string area
+     *  char[StringSize]                    null terminated names
+     *
+     * All fields are little endian, a blob written on a big endian machine fails the magic check.
+     */
+    static const uint32_t CompiledMagic         = 0x574f4c46;   /**< "FLOW" */
+    /** Bump whenever the layout changes, blobs of other versions are rejected */
+    static const uint32_t CompiledFormatVersion = 1;
+
+    struct CompiledHeader
+    {
+        uint32_t    Magic;
+        uint32_t    Version;
+        uint32_t    Size;               /**< Size of the whole blob in bytes */
+        uint32_t    NodeCount;
+        uint32_t    QueryCount;
+        uint32_t    EventCount;
+        uint32_t    VariableCount;
+        uint32_t    NameCount;
+        uint32_t    DefinitionOffset;
+        uint32_t    EventOffset;
+        uint32_t    VariableOffset;
+        uint32_t    NameOffset;
+        uint32_t    StringOffset;
+        uint32_t    StringSize;
+        uint32_t    Reserved[2];
+    };
+
+    /** The records are laid out as in a FlatDocument, except that Name indexes the blob's own name table */
+    typedef FlatDefinition  CompiledDefinition;
+    typedef FlatEvent       CompiledEvent;
+    typedef FlatVariable    CompiledVariable;
+
+    static_assert(sizeof(CompiledHeader) == 64, "CompiledHeader must not contain padding");
+
+    /**
+     * \brief   Serializes a document into the compiled format.
+     * \param   a_Document  The document.
+     * \param   a_Names     The symbol table the names of the document refer to.
+     * \param   a_Blob      Receives the compiled document.
+     *
+     * \return  true if the document was compiled successfully, or false if a name is missing 
+     *          or the blob would exceed 4 GB.
+     */
+    bool CompileDocument(const FlowDocument & a_Document, const SymbolTable & a_Names, std::vector<char> & a_Blob);
+    bool CompileDocument(const FlowDocument & a_Document, const ConcurrentSymbolTable & a_Names, std::vector<char> & a_Blob);
+
+    /**
+     * \brief   A compiled document used in place.
+     *
+     * Loading validates the blob once, after that every accessor is a plain array access
+     * into the blob and nothing is allocated per definition.
+     */
+    class CompiledDocument
+    {
+    public:
+        CompiledDocument();
+
+        /**
+         * \brief   Validates a blob and uses it in place.
+         * \param   a_Data  The blob, must be 4-byte aligned and outlive the document.
+         * \param   a_Size  Size of the blob in bytes.
+         *
+         * \return  true if the blob is a valid compiled document, or false otherwise.
+         */
+        bool Load(const void * a_Data, size_t a_Size);
+        /**
+         * \brief   Memory maps a compiled file read-only and uses it in place.
+         */
+        bool LoadFile(const char * a_Path);
+        /**
+         * \brief   Takes ownership of a blob in memory, for documents that were just compiled.
+         */
+        bool LoadBlob(std::vector<char> && a_Blob);
+        void Close();
+
+        bool                        IsLoaded() const        {return m_pHeader != nullptr;}
+        const std::string &         GetErrorString() const  {return m_ErrorString;}
+
+        uint32_t                    NodeCount() const       {return m_pHeader->NodeCount;}
+        uint32_t                    QueryCount() const      {return m_pHeader->QueryCount;}
+        uint32_t                    NameCount() const       {return m_pHeader->NameCount;}
+        const CompiledDefinition &  Node(uint32_t i) const  {return m_pDefinitions[i];}
+        const CompiledDefinition &  Query(uint32_t i) const {return m_pDefinitions[m_pHeader->NodeCount + i];}
+        const CompiledEvent &       Event(uint32_t i) const {return m_pEvents[i];}
+        const CompiledVariable &    Variable(uint32_t i) const  {return m_pVariables[i];}
+        /** Returns a name from the document's own name table */
+        const char *                GetString(uint32_t a_Name) const  {return m_pStrings + m_pNames[a_Name];}
+
+        /** The raw blob */
+        const void *                Data() const            {return m_pHeader;}
+        size_t                      Size() const            {return m_pHeader ? m_pHeader->Size : 0;}
+
+    protected:
+        CompiledDocument(const CompiledDocument &);
+        CompiledDocument & operator=(const CompiledDocument &);
+
+        bool Fail(const char * a_Error);
+
+        const CompiledHeader *      m_pHeader;
+        const CompiledDefinition *  m_pDefinitions;
+        const CompiledEvent *       m_pEvents;
+        const CompiledVariable *    m_pVariables;
+        const uint32_t *            m_pNames;
+        const char *                m_pStrings;
+
+        MappedFile                  m_File;     /**< Backing storage for LoadFile */
+        std::vector<char>           m_Blob;     /**< Backing storage for LoadBlob */
+        std::string                 m_ErrorString;
+    };
+}
+
+#endif
@@ -0,0 +1,218 @@
+#include "concurrent_symbol_table.h"
+
+#include <cstring>
+
+namespace flow
+{
+    /** Maps an index to its block and the position within the block */
+    static inline unsigned BlockOf(uint32_t a_Index, unsigned a_BaseBits, uint32_t * a_Offset)
+    {
+        uint64_t v = static_cast<uint64_t>(a_Index) + (1ull << a_BaseBits);
+        unsigned bits = 63;
+        while(!(v >> bits)) {
+            --bits;
+        }
+        *a_Offset = static_cast<uint32_t>(v - (1ull << bits));
+        return bits - a_BaseBits;
+    }
+
+    ConcurrentSymbolTable::Table::Table(size_t a_Count) : m_nMask(a_Count - 1), m_Slots(new std::atomic<uint64_t>[a_Count])
+    {
+        for(size_t i = 0; i < a_Count; ++i) {
+            m_Slots[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentSymbolTable::ConcurrentSymbolTable() : m_nNextIndex(0), m_nSize(0)
+    {
+        for(unsigned i = 0; i < MaxBlocks; ++i) {
+            m_Blocks[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ConcurrentSymbolTable::~ConcurrentSymbolTable()
+    {
+        for(Stripe & stripe : m_Stripes) {
+            delete stripe.m_pTable.load(std::memory_order_relaxed);
+            for(Table * pTable : stripe.m_Retired) {
+                delete pTable;
+            }
+        }
+        for(unsigned i = 0; i < MaxBlocks; ++i) {
+            delete [] m_Blocks[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    const ConcurrentSymbolTable::Entry * ConcurrentSymbolTable::GetEntry(SymIndex a_Index) const
+    {
+        uint32_t offset;
+        unsigned block = BlockOf(a_Index, BaseBlockBits, &offset);
+        const Entry * pBlock = m_Blocks[block].load(std::memory_order_acquire);
+        return pBlock ? (pBlock + offset) : nullptr;
+    }
+
+    ConcurrentSymbolTable::Entry * ConcurrentSymbolTable::AllocateEntry(SymIndex a_Index)
+    {
+        uint32_t offset;
+        unsigned block = BlockOf(a_Index, BaseBlockBits, &offset);
+        Entry * pBlock = m_Blocks[block].load(std::memory_order_acquire);
+        if (!pBlock) {
+            /** several stripes may race for a new block, the loser frees its copy. Zeroed, so the 
+                entries of indices whose insert failed read as missing */
+            Entry * pNew = new (std::nothrow) Entry[static_cast<size_t>(1) << (block + BaseBlockBits)]();
+            if (!pNew) {
+                return nullptr;
+            }
+            if (m_Blocks[block].compare_exchange_strong(pBlock, pNew, std::memory_order_acq_rel)) {
+                pBlock = pNew;
+            } else {
+                delete [] pNew;
+            }
+        }
+        return pBlock + offset;
+    }
+
+    ConcurrentSymbolTable::SymIndex ConcurrentSymbolTable::Probe(const Table * pTable, const char * pStr, size_t length, uint32_t hash) const
+    {
+        if (!pTable) {
+            return SymbolTable::InvalidIndex;
+        }
+        size_t slot = hash & pTable->m_nMask;
+        for(;;) {
+            uint64_t value = pTable->m_Slots[slot].load(std::memory_order_acquire);
+            if (value == 0) {
+                return SymbolTable::InvalidIndex;
+            }
+            if (static_cast<uint32_t>(value >> 32) == hash) {
+                SymIndex index = static_cast<SymIndex>(value) - 1;
+                const Entry * pEntry = GetEntry(index);
+                if ((pEntry->m_nLength == length) && (memcmp(pEntry->m_pStr, pStr, length) == 0)) {
+                    return index;
+                }
+            }
+            slot = (slot + 1) & pTable->m_nMask;
+        }
+    }
+
+    ConcurrentSymbolTable::SymIndex ConcurrentSymbolTable::Find(const char * pStr, size_t length) const
+    {
+        if (!pStr) {
+            return SymbolTable::InvalidIndex;
+        }
+        uint32_t hash = SymbolTable::Hash(pStr, length);
+        const Stripe & stripe = m_Stripes[hash >> (32 - StripeBits)];
+        return Probe(stripe.m_pTable.load(std::memory_order_acquire), pStr, length, hash);
+    }
+
+    /**
+     * Doubles the slots of a stripe, called with the stripe locked.
+     */
+    bool ConcurrentSymbolTable::Grow(Stripe & a_Stripe)
+    {
+        Table * pOld = a_Stripe.m_pTable.load(std::memory_order_relaxed);
+        size_t count = pOld ? (pOld->m_nMask + 1) * 2 : 64;
+        Table * pNew = new (std::nothrow) Table(count);
+        if (!pNew || !pNew->m_Slots) {
+            delete pNew;
+            return false;
+        }
+        if (pOld) {
+            for(size_t i = 0; i <= pOld->m_nMask; ++i) {
+                uint64_t value = pOld->m_Slots[i].load(std::memory_order_relaxed);
+                if (value == 0) {
+                    continue;
+                }
+                size_t slot = static_cast<uint32_t>(value >> 32) & pNew->m_nMask;
+                while(pNew->m_Slots[slot].load(std::memory_order_relaxed) != 0) {
+                    slot = (slot + 1) & pNew->m_nMask;
+                }
+                pNew->m_Slots[slot].store(value, std::memory_order_relaxed);
+            }
+            a_Stripe.m_Retired.push_back(pOld);
+        }
+        a_Stripe.m_pTable.store(pNew, std::memory_order_release);
+        return true;
+    }
+
+    ConcurrentSymbolTable::SymIndex ConcurrentSymbolTable::Insert(const char * pStr, size_t length)
+    {
+        if (!pStr || (length >= 0xffffffffu)) {
+            return SymbolTable::InvalidIndex;
+        }
+        uint32_t hash = SymbolTable::Hash(pStr, length);
+        Stripe & stripe = m_Stripes[hash >> (32 - StripeBits)];
+        SymIndex index = Probe(stripe.m_pTable.load(std::memory_order_acquire), pStr, length, hash);
+        if (index != SymbolTable::InvalidIndex) {
+            return index;
+        }
+
+        std::lock_guard<std::mutex> lock(stripe.m_Lock);
+        /** keep the load factor at or below one half */
+        Table * pTable = stripe.m_pTable.load(std::memory_order_relaxed);
+        if (!pTable || ((stripe.m_nCount + 1) * 2 > pTable->m_nMask + 1)) {
+            if (!Grow(stripe)) {
+                return SymbolTable::InvalidIndex;
+            }
+            pTable = stripe.m_pTable.load(std::memory_order_relaxed);
+        }
+        /** the string may have been inserted while waiting for the lock */
+        size_t slot = hash & pTable->m_nMask;
+        for(;;) {
+            uint64_t value = pTable->m_Slots[slot].load(std::memory_order_relaxed);
+            if (value == 0) {
+                break;
+            }
+            if (static_cast<uint32_t>(value >> 32) == hash) {
+                SymIndex existing = static_cast<SymIndex>(value) - 1;
+                const Entry * pEntry = GetEntry(existing);
+                if ((pEntry->m_nLength == length) && (memcmp(pEntry->m_pStr, pStr, length) == 0)) {
+                    return existing;
+                }
+            }
+            slot = (slot + 1) & pTable->m_nMask;
+        }
+
+        const char * pCopy = stripe.m_Strings.InsertString(pStr, length);
+        if (!pCopy) {
+            return SymbolTable::InvalidIndex;
+        }
+        /** the counter stops at the last index instead of wrapping around to ones already handed out */
+        index = m_nNextIndex.load(std::memory_order_relaxed);
+        do {
+            if (index >= SymbolTable::InvalidIndex - 1) {
+                return SymbolTable::InvalidIndex;
+            }
+        } while(!m_nNextIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+        Entry * pEntry = AllocateEntry(index);
+        if (!pEntry) {
+            return SymbolTable::InvalidIndex;
+        }
+        pEntry->m_pStr      = pCopy;
+        pEntry->m_nLength   = static_cast<uint32_t>(length);
+        pEntry->m_nHash     = hash;
+        /** publishing the slot makes the entry and the string visible to lookups */
+        pTable->m_Slots[slot].store((static_cast<uint64_t>(hash) << 32) | (static_cast<uint64_t>(index) + 1), std::memory_order_release);
+        ++stripe.m_nCount;
+        m_nSize.fetch_add(1, std::memory_order_release);
+        return index;
+    }
+
+    const char * ConcurrentSymbolTable::Retrive(SymIndex index) const
+    {
+        if (index >= m_nNextIndex.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        /** an index taken by an insert that failed has no string */
+        const Entry * pEntry = GetEntry(index);
+        return pEntry ? pEntry->m_pStr : nullptr;
+    }
+
+    size_t ConcurrentSymbolTable::Length(SymIndex index) const
+    {
+        if (index >= m_nNextIndex.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        const Entry * pEntry = GetEntry(index);
+        return pEntry ? pEntry->m_nLength : 0;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef _FLOW_CONCURRENT_SYMBOL_TABLE_H_
+#define _FLOW_CONCURRENT_SYMBOL_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pool.h"
+#include "token.h"
+
+namespace flow
+{
+    /**
+     * \brief   A symbol table that can be shared by several threads.
+     *
+     * The strings are spread over a number of stripes by the high bits of their hash, each 
+     * stripe being an open addressing table of atomic slots. Lookups never lock, they 
+     * probe the current table of the stripe and publication of a slot is what makes its 
+     * entry visible. Inserts lock only their own stripe, copy the string into the stripe's 
+     * arena and take the next index from a shared counter, so all threads intern into one 
+     * dense index space. Tables that are replaced when a stripe grows are kept until the 
+     * symbol table is destroyed, so a concurrent lookup never touches freed memory.
+     */
+    class ConcurrentSymbolTable
+    {
+    public:
+        typedef SymbolTable::SymIndex SymIndex;
+
+        ConcurrentSymbolTable();
+        ~ConcurrentSymbolTable();
+
+        SymIndex        Insert(const char *, size_t);
+        /** Lookup only, never locks or allocates. Returns SymbolTable::InvalidIndex if the string hasn't been interned */
+        SymIndex        Find(const char *, size_t) const;
+        /** Valid for any index returned by Insert or Find, from any thread, nullptr for any other index */
+        const char *    Retrive(SymIndex index) const;
+        size_t          Length(SymIndex index) const;
+        /** Number of interned strings */
+        size_t          Size() const        {return m_nSize.load(std::memory_order_acquire);}
+
+    protected:
+        ConcurrentSymbolTable(const ConcurrentSymbolTable &);
+        ConcurrentSymbolTable & operator=(const ConcurrentSymbolTable &);
+
+        struct Entry {
+            const char *    m_pStr;
+            uint32_t        m_nLength;
+            uint32_t        m_nHash;
+        };
+
+        /** A slot holds the hash in the upper half and index + 1 in the lower, 0 is empty */
+        struct Table {
+            explicit Table(size_t a_Count);
+
+            size_t                                  m_nMask;
+            std::unique_ptr<std::atomic<uint64_t>[]> m_Slots;
+        };
+
+        struct alignas(64) Stripe {
+            Stripe() : m_pTable(nullptr), m_nCount(0)
+            {
+            }
+
+            std::atomic<Table *>    m_pTable;
+            std::mutex              m_Lock;         /**< Serializes inserts into the stripe */
+            size_t                  m_nCount;
+            Arena                   m_Strings;
+            std::vector<Table *>    m_Retired;
+        };
+
+        /** Entries live in blocks of doubling size, so an index maps to a block without a lookup table */
+        static const unsigned   BaseBlockBits   = 10;
+        static const unsigned   MaxBlocks       = 32 - BaseBlockBits + 1;
+        static const unsigned   StripeBits      = 6;
+
+        SymIndex        Probe(const Table *, const char *, size_t, uint32_t) const;
+        const Entry *   GetEntry(SymIndex) const;
+        Entry *         AllocateEntry(SymIndex);
+        bool            Grow(Stripe &);
+
+        Stripe                      m_Stripes[1 << StripeBits];
+        std::atomic<Entry *>        m_Blocks[MaxBlocks];
+        std::atomic<uint32_t>       m_nNextIndex;
+        std::atomic<size_t>         m_nSize;
+    };
+}
+
+#endif
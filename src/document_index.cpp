@@ -0,0 +1,292 @@
+#include "document_index.h"
+
+namespace flow
+{
+    void DocumentIndex::Table::Reset(size_t a_Count)
+    {
+        /** a load factor of at most one half keeps the probes short */
+        size_t size = 16;
+        while(size < a_Count * 2) {
+            size *= 2;
+        }
+        m_Slots.assign(size, Slot{EmptyKey, 0});
+        m_nMask     = size - 1;
+        m_nCount    = 0;
+    }
+
+    void DocumentIndex::Table::Reserve(size_t a_Count)
+    {
+        size_t size = m_Slots.empty() ? 16 : m_Slots.size();
+        while(size < a_Count * 2) {
+            size *= 2;
+        }
+        if (size == m_Slots.size()) {
+            return;
+        }
+        std::vector<Slot> slots;
+        slots.swap(m_Slots);
+        m_Slots.assign(size, Slot{EmptyKey, 0});
+        m_nMask = size - 1;
+        for(const Slot & old : slots) {
+            if (old.m_nKey != EmptyKey) {
+                size_t slot = Hash(old.m_nKey) & m_nMask;
+                while(m_Slots[slot].m_nKey != EmptyKey) {
+                    slot = (slot + 1) & m_nMask;
+                }
+                m_Slots[slot] = old;
+            }
+        }
+    }
+
+    /**
+     * The final mix of MurmurHash3, the keys are small integers so every bit has to be mixed.
+     */
+    size_t DocumentIndex::Table::Hash(uint64_t a_Key)
+    {
+        a_Key ^= a_Key >> 33;
+        a_Key *= 0xff51afd7ed558ccdULL;
+        a_Key ^= a_Key >> 33;
+        a_Key *= 0xc4ceb9fe1a85ec53ULL;
+        a_Key ^= a_Key >> 33;
+        return static_cast<size_t>(a_Key);
+    }
+
+    bool DocumentIndex::Table::Insert(uint64_t a_Key, uint32_t a_Value)
+    {
+        if ((m_nCount + 1) * 2 > m_Slots.size()) {
+            Reserve(m_nCount + 1);
+        }
+        size_t slot = Hash(a_Key) & m_nMask;
+        while(m_Slots[slot].m_nKey != EmptyKey) {
+            if (m_Slots[slot].m_nKey == a_Key) {
+                return false;
+            }
+            slot = (slot + 1) & m_nMask;
+        }
+        m_Slots[slot].m_nKey    = a_Key;
+        m_Slots[slot].m_nValue  = a_Value;
+        ++m_nCount;
+        return true;
+    }
+
+    uint32_t DocumentIndex::Table::Find(uint64_t a_Key) const
+    {
+        if (m_Slots.empty()) {
+            return NotFound;
+        }
+        size_t slot = Hash(a_Key) & m_nMask;
+        while(m_Slots[slot].m_nKey != EmptyKey) {
+            if (m_Slots[slot].m_nKey == a_Key) {
+                return m_Slots[slot].m_nValue;
+            }
+            slot = (slot + 1) & m_nMask;
+        }
+        return NotFound;
+    }
+
+    DocumentIndex::DocumentIndex()
+    {
+    }
+
+    /** Queries are told apart from nodes at the same position by the top bit */
+    static inline uint64_t MemberKey(uint32_t a_Definition, SymbolTable::SymIndex a_Name)
+    {
+        return (static_cast<uint64_t>(a_Definition) << 32) | a_Name;
+    }
+
+    /** The events and variables of a definition, for both document representations */
+    template<class Definition>
+    static size_t EventCount(const FlowDocument &, const Definition & a_Definition)
+    {
+        return a_Definition.Events.size();
+    }
+
+    template<class Definition>
+    static size_t VariableCount(const FlowDocument &, const Definition & a_Definition)
+    {
+        return a_Definition.Variables.size();
+    }
+
+    template<class Definition>
+    static SymbolTable::SymIndex DefinitionName(const Definition & a_Definition)
+    {
+        return a_Definition.NameIndex;
+    }
+
+    template<class Definition>
+    static SymbolTable::SymIndex EventName(const FlowDocument &, const Definition & a_Definition, size_t i)
+    {
+        return a_Definition.Events[i].NameIndex;
+    }
+
+    template<class Definition>
+    static SymbolTable::SymIndex VariableName(const FlowDocument &, const Definition & a_Definition, size_t i)
+    {
+        return a_Definition.Variables[i].NameIndex;
+    }
+
+    static size_t EventCount(const FlatDocument &, const FlatDefinition & a_Definition)
+    {
+        return a_Definition.EventCount;
+    }
+
+    static size_t VariableCount(const FlatDocument &, const FlatDefinition & a_Definition)
+    {
+        return a_Definition.VariableCount;
+    }
+
+    static SymbolTable::SymIndex DefinitionName(const FlatDefinition & a_Definition)
+    {
+        return a_Definition.Name;
+    }
+
+    static SymbolTable::SymIndex EventName(const FlatDocument & a_Document, const FlatDefinition & a_Definition, size_t i)
+    {
+        return a_Document.Events[a_Definition.FirstEvent + i].Name;
+    }
+
+    static SymbolTable::SymIndex VariableName(const FlatDocument & a_Document, const FlatDefinition & a_Definition, size_t i)
+    {
+        return a_Document.Variables[a_Definition.FirstVariable + i].Name;
+    }
+
+    template<class Names>
+    void DocumentIndex::Duplicate(const char * a_What, SymbolTable::SymIndex a_Name, const Names & a_Names, SymbolTable::SymIndex a_Owner)
+    {
+        if (!m_ErrorString.empty()) {
+            return;     /** only the first duplicate is reported */
+        }
+        const char * name = a_Names.Retrive(a_Name);
+        m_ErrorString = std::string("DUPLICATE ") + a_What + " " + (name ? name : "?");
+        if (a_Owner != SymbolTable::InvalidIndex) {
+            const char * owner = a_Names.Retrive(a_Owner);
+            m_ErrorString += std::string(" IN ") + (owner ? owner : "?");
+        }
+    }
+
+    void DocumentIndex::AddDefinition(bool a_IsQuery, uint32_t a_Definition, SymbolTable::SymIndex a_Name)
+    {
+        m_Pending.push_back(PendingName{a_Name, a_Definition | (a_IsQuery ? QueryBit : 0), SymbolTable::InvalidIndex});
+    }
+
+    void DocumentIndex::AddMember(bool a_IsQuery, uint32_t a_Definition, SymbolTable::SymIndex a_Owner, bool a_IsVariable, uint32_t a_Member,
+        SymbolTable::SymIndex a_Name)
+    {
+        m_Pending.push_back(PendingName{MemberKey(a_Definition | (a_IsQuery ? QueryBit : 0), a_Name), 
+            a_Member | (a_IsVariable ? VariableBit : 0), a_Owner});
+    }
+
+    template<class Names>
+    bool DocumentIndex::CommitPending(const Names & a_Names)
+    {
+        size_t definitions = 0;
+        for(const PendingName & pending : m_Pending) {
+            definitions += (pending.m_nOwner == SymbolTable::InvalidIndex) ? 1 : 0;
+        }
+        m_Definitions.Reserve(m_Definitions.Size() + definitions);
+        m_Members.Reserve(m_Members.Size() + m_Pending.size() - definitions);
+
+        bool unique = true;
+        for(const PendingName & pending : m_Pending) {
+            if (pending.m_nOwner == SymbolTable::InvalidIndex) {
+                if (!m_Definitions.Insert(pending.m_nKey, pending.m_nValue)) {
+                    Duplicate("DEFINITION", static_cast<SymbolTable::SymIndex>(pending.m_nKey), a_Names, SymbolTable::InvalidIndex);
+                    unique = false;
+                }
+            } else if (!m_Members.Insert(pending.m_nKey, pending.m_nValue)) {
+                Duplicate("MEMBER", static_cast<SymbolTable::SymIndex>(pending.m_nKey), a_Names, pending.m_nOwner);
+                unique = false;
+            }
+        }
+        m_Pending.clear();
+        return unique;
+    }
+
+    bool DocumentIndex::Commit(const SymbolTable & a_Names)
+    {
+        return CommitPending(a_Names);
+    }
+
+    template<class Document, class Names>
+    bool DocumentIndex::BuildIndex(const Document & a_Document, const Names & a_Names)
+    {
+        m_ErrorString = "";
+        m_Definitions.Reset(0);
+        m_Members.Reset(0);
+        m_Pending.clear();
+
+        auto add = [&](const auto & a_Definition, bool a_IsQuery, uint32_t a_Position) {
+            SymbolTable::SymIndex name = DefinitionName(a_Definition);
+            AddDefinition(a_IsQuery, a_Position, name);
+            for(size_t i = 0; i < EventCount(a_Document, a_Definition); ++i) {
+                AddMember(a_IsQuery, a_Position, name, false, static_cast<uint32_t>(i), EventName(a_Document, a_Definition, i));
+            }
+            for(size_t i = 0; i < VariableCount(a_Document, a_Definition); ++i) {
+                AddMember(a_IsQuery, a_Position, name, true, static_cast<uint32_t>(i), VariableName(a_Document, a_Definition, i));
+            }
+        };
+        for(size_t i = 0; i < a_Document.Nodes.size(); ++i) {
+            add(a_Document.Nodes[i], false, static_cast<uint32_t>(i));
+        }
+        for(size_t i = 0; i < a_Document.Queries.size(); ++i) {
+            add(a_Document.Queries[i], true, static_cast<uint32_t>(i));
+        }
+        return CommitPending(a_Names);
+    }
+
+    bool DocumentIndex::Build(const FlowDocument & a_Document, const SymbolTable & a_Names)
+    {
+        return BuildIndex(a_Document, a_Names);
+    }
+
+    bool DocumentIndex::Build(const FlowDocument & a_Document, const ConcurrentSymbolTable & a_Names)
+    {
+        return BuildIndex(a_Document, a_Names);
+    }
+
+    bool DocumentIndex::Build(const FlatDocument & a_Document, const SymbolTable & a_Names)
+    {
+        return BuildIndex(a_Document, a_Names);
+    }
+
+    uint32_t DocumentIndex::FindNode(SymbolTable::SymIndex a_Name) const
+    {
+        uint32_t definition = m_Definitions.Find(a_Name);
+        return ((definition & QueryBit) == 0) ? definition : NotFound;
+    }
+
+    uint32_t DocumentIndex::FindQuery(SymbolTable::SymIndex a_Name) const
+    {
+        uint32_t definition = m_Definitions.Find(a_Name);
+        return ((definition != NotFound) && ((definition & QueryBit) != 0)) ? (definition & ~QueryBit) : NotFound;
+    }
+
+    uint32_t DocumentIndex::FindMember(uint32_t a_Definition, SymbolTable::SymIndex a_Name, bool a_Variable) const
+    {
+        uint32_t member = m_Members.Find(MemberKey(a_Definition, a_Name));
+        if ((member == NotFound) || (((member & VariableBit) != 0) != a_Variable)) {
+            return NotFound;
+        }
+        return member & ~VariableBit;
+    }
+
+    uint32_t DocumentIndex::FindNodeEvent(uint32_t a_Node, SymbolTable::SymIndex a_Name) const
+    {
+        return (a_Node < QueryBit) ? FindMember(a_Node, a_Name, false) : NotFound;
+    }
+
+    uint32_t DocumentIndex::FindNodeVariable(uint32_t a_Node, SymbolTable::SymIndex a_Name) const
+    {
+        return (a_Node < QueryBit) ? FindMember(a_Node, a_Name, true) : NotFound;
+    }
+
+    uint32_t DocumentIndex::FindQueryEvent(uint32_t a_Query, SymbolTable::SymIndex a_Name) const
+    {
+        return (a_Query < QueryBit) ? FindMember(a_Query | QueryBit, a_Name, false) : NotFound;
+    }
+
+    uint32_t DocumentIndex::FindQueryVariable(uint32_t a_Query, SymbolTable::SymIndex a_Name) const
+    {
+        return (a_Query < QueryBit) ? FindMember(a_Query | QueryBit, a_Name, true) : NotFound;
+    }
+}
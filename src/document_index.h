@@ -0,0 +1,139 @@
+#ifndef _FLOW_DOCUMENT_INDEX_H_
+#define _FLOW_DOCUMENT_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "concurrent_symbol_table.h"
+#include "parser.h"
+
+namespace flow
+{
+    /**
+     * \brief   Finds the definitions of a document and their events and variables by name.
+     *
+     * The index is filled while a document is parsed, see Parser::Parse(), or built in one 
+     * pass over a document that was parsed before. Every lookup is a probe into a flat hash 
+     * table keyed by symbol index, so no strings are compared. Nodes and queries share one 
+     * namespace, and so do the events and variables of a definition.
+     *
+     * Lookups return positions, a node or query is found at that position in the document's
+     * Nodes or Queries, an event or variable at that position within its definition.
+     */
+    class DocumentIndex
+    {
+    public:
+        static const uint32_t NotFound = 0xffffffffu;
+
+        DocumentIndex();
+
+        /**
+         * \brief   Indexes a document, replacing the previous contents of the index.
+         * \param   a_Document  The document, positions refer to it until it is modified.
+         * \param   a_Names     The symbol table the names of the document refer to.
+         *
+         * \return  true if every name is unique, or false if a name is defined twice, in 
+         *          which case the first definition is indexed and the error is reported.
+         */
+        bool Build(const FlowDocument & a_Document, const SymbolTable & a_Names);
+        bool Build(const FlowDocument & a_Document, const ConcurrentSymbolTable & a_Names);
+        bool Build(const FlatDocument & a_Document, const SymbolTable & a_Names);
+
+        /**
+         * \brief   Adds a definition or one of its members, for indexing a document while it is parsed.
+         * \param   a_Definition    Position of the definition in the document's Nodes or Queries.
+         * \param   a_Owner         Name of the definition the member belongs to.
+         * \param   a_Member        Position of the member in the definition's Events or Variables.
+         *
+         * The names are queued and inserted together by Commit(), so the tables are sized once 
+         * and the parse isn't interleaved with probes into them.
+         */
+        void AddDefinition(bool a_IsQuery, uint32_t a_Definition, SymbolTable::SymIndex a_Name);
+        void AddMember(bool a_IsQuery, uint32_t a_Definition, SymbolTable::SymIndex a_Owner, bool a_IsVariable, uint32_t a_Member,
+            SymbolTable::SymIndex a_Name);
+        /**
+         * \brief   Indexes the names added since the last Build() or Commit().
+         * \return  true if every name is unique, or false if a name is taken, in which case the 
+         *          first duplicate in the order they were added is reported as by Build().
+         */
+        bool Commit(const SymbolTable & a_Names);
+
+        uint32_t    FindNode(SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindQuery(SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindNodeEvent(uint32_t a_Node, SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindNodeVariable(uint32_t a_Node, SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindQueryEvent(uint32_t a_Query, SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindQueryVariable(uint32_t a_Query, SymbolTable::SymIndex a_Name) const;
+
+        /**
+         * \brief   Describes the first duplicate name found since the last Build().
+         */
+        const std::string & GetErrorString() const  {return m_ErrorString;}
+
+    protected:
+        DocumentIndex(const DocumentIndex &);
+        DocumentIndex & operator=(const DocumentIndex &);
+
+        /**
+         * \brief   An open addressing table from 64-bit keys to 32-bit values.
+         */
+        class Table
+        {
+        public:
+            Table() : m_nMask(0), m_nCount(0)
+            {
+            }
+
+            /** Empties the table and sizes it for a_Count keys, more can be inserted */
+            void        Reset(size_t a_Count);
+            /** Makes room for a_Count keys in total, the table grows by itself past that */
+            void        Reserve(size_t a_Count);
+            size_t      Size() const    {return m_nCount;}
+            /** Returns false and leaves the table unchanged if the key is present */
+            bool        Insert(uint64_t a_Key, uint32_t a_Value);
+            uint32_t    Find(uint64_t a_Key) const;
+
+        protected:
+            static const uint64_t EmptyKey = ~0ULL;
+
+            struct Slot {
+                uint64_t    m_nKey;
+                uint32_t    m_nValue;
+            };
+
+            static size_t Hash(uint64_t a_Key);
+
+            std::vector<Slot>   m_Slots;
+            size_t              m_nMask;
+            size_t              m_nCount;
+        };
+
+        /** A definition or member waiting for Commit(), definitions have no owner */
+        struct PendingName {
+            uint64_t                m_nKey;
+            uint32_t                m_nValue;
+            SymbolTable::SymIndex   m_nOwner;
+        };
+
+        /** Definition values carry the kind in the top bit, queries have it set */
+        static const uint32_t QueryBit = 0x80000000u;
+        /** Member values carry the kind in the top bit */
+        static const uint32_t VariableBit = 0x80000000u;
+
+        template<class Document, class Names>
+        bool        BuildIndex(const Document & a_Document, const Names & a_Names);
+        template<class Names>
+        void        Duplicate(const char * a_What, SymbolTable::SymIndex a_Name, const Names & a_Names, SymbolTable::SymIndex a_Owner);
+        template<class Names>
+        bool        CommitPending(const Names & a_Names);
+        uint32_t    FindMember(uint32_t a_Definition, SymbolTable::SymIndex a_Name, bool a_Variable) const;
+
+        Table                       m_Definitions;  /**< From name to definition */
+        Table                       m_Members;      /**< From definition and name to event or variable */
+        std::vector<PendingName>    m_Pending;      /**< Added but not yet committed */
+        std::string                 m_ErrorString;
+    };
+}
+
+#endif
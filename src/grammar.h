@@ -0,0 +1,294 @@
+#ifndef _FLOW_GRAMMAR_H_
+#define _FLOW_GRAMMAR_H_
+
+#include "parser.h"
+
+namespace flow
+{
+    typedef enum {
+        GRAMMAR_OK,
+        GRAMMAR_EXPECTED,       /**< One symbol was expected but another was found */
+        GRAMMAR_UNEXPECTED      /**< A symbol was found where it isn't allowed */
+    } GrammarStatus;
+
+    /**
+     * \brief   The grammar of node and query definitions, shared by the Parser and by the
+     *          StaticParser that runs during constant evaluation.
+     *
+     * Tokens is a tokenizer with GetSym(), Peek(), SymIndex(), IntValue() and RealValue().
+     * A definition is reported to a builder through its SetName(), AddEvent() and AddVariable(),
+     * which return false to stop the parse. The grammar stops at the first error and records
+     * it, the caller reports it at the position the tokenizer stopped at.
+     */
+    template<class Tokens>
+    class Grammar
+    {
+    public:
+        constexpr explicit Grammar(Tokens & a_Tokenizer) :
+            Status(GRAMMAR_OK), Expected(T_EOF), Actual(T_EOF), m_Tokenizer(a_Tokenizer)
+        {
+        }
+
+        template<class Definition>
+        constexpr bool ParseNode(Definition & a_Node);
+        template<class Definition>
+        constexpr bool ParseQuery(Definition & a_Query);
+        constexpr bool ParseVariable(FlowVariable & a_Variable);
+        constexpr bool ParseEvent(FlowEvent & a_Event);
+
+        /** Records a symbol that isn't allowed where it was found, returns false */
+        constexpr bool Unexpected(Symbol_t a_Sym);
+
+        GrammarStatus   Status;
+        Symbol_t        Expected;   /**< Only valid for GRAMMAR_EXPECTED */
+        Symbol_t        Actual;
+
+    protected:
+        constexpr bool Expect(Symbol_t a_Expected);
+
+        Tokens &        m_Tokenizer;
+    };
+
+    template<class Tokens>
+    constexpr bool Grammar<Tokens>::Expect(Symbol_t a_Expected)
+    {
+        Symbol_t actual = m_Tokenizer.GetSym();
+        if (actual != a_Expected) {
+            Status      = GRAMMAR_EXPECTED;
+            Expected    = a_Expected;
+            Actual      = actual;
+            return false;
+        }
+        return true;
+    }
+
+    template<class Tokens>
+    constexpr bool Grammar<Tokens>::Unexpected(Symbol_t a_Sym)
+    {
+        Status  = GRAMMAR_UNEXPECTED;
+        Actual  = a_Sym;
+        return false;
+    }
+
+    /**
+     * \brief   Parses a flow node definition.
+     */
+    template<class Tokens>
+    template<class Definition>
+    constexpr bool Grammar<Tokens>::ParseNode(Definition & a_Node)
+    {
+        if (!Expect(T_KEYWORD_NODE)) {
+            return false;
+        }
+
+        if (!Expect(T_IDENT)) {
+            return false;
+        }
+
+        if (!a_Node.SetName(m_Tokenizer.SymIndex())) {
+            return false;
+        }
+
+        if (!Expect(T_LEFT_CURLY_BRACKET)) {
+            return false;
+        }
+
+        Symbol_t prefix = m_Tokenizer.Peek();
+
+        for(;;) {
+            if ((prefix == flow::T_TYPE_FLOAT) || (prefix == flow::T_TYPE_BOOL)) {
+                /** Variable declaration without prefix */
+                FlowVariable variable = {};
+                if (!ParseVariable(variable)) {
+                    return false;
+                }
+                if (!a_Node.AddVariable(variable)) {
+                    return false;
+                }
+            } else if ((prefix == flow::T_KEYWORD_IN) || (prefix == flow::T_KEYWORD_OUT)) {
+                m_Tokenizer.GetSym();   // consume.
+                Symbol_t sym = m_Tokenizer.Peek();
+                if ((sym == flow::T_TYPE_BOOL) || (sym == flow::T_TYPE_FLOAT)) {
+                    FlowVariable variable = {};
+                    if (!ParseVariable(variable)) {
+                        return false;
+                    }
+                    variable.HasDirection = 1;
+                    variable.Direction = (prefix == flow::T_KEYWORD_IN) ? flow::FlowEvent::EVENT_IN : flow::FlowEvent::EVENT_OUT;
+                    if (!a_Node.AddVariable(variable)) {
+                        return false;
+                    }
+                } else {
+                    // should be a event.
+                    FlowEvent ev = {};
+                    if (!ParseEvent(ev)) {
+                        return false;
+                    }
+                    ev.Direction = (prefix == flow::T_KEYWORD_IN) ? flow::FlowEvent::EVENT_IN : flow::FlowEvent::EVENT_OUT;
+                    if (!a_Node.AddEvent(ev)) {
+                        return false;
+                    }
+                }
+            } else {
+                break;
+            }
+            prefix = m_Tokenizer.Peek();
+        }
+
+        if (!Expect(T_RIGHT_CURLY_BRACKET)) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Parses a variable declaration.
+     */
+    template<class Tokens>
+    constexpr bool Grammar<Tokens>::ParseVariable(FlowVariable & a_Variable)
+    {
+        Symbol_t sym = m_Tokenizer.GetSym();
+        if (sym == flow::T_TYPE_FLOAT) {
+            a_Variable.Type = FlowVariable::TYPE_FLOAT;
+            // should be followed by a name.
+            if (!Expect(flow::T_IDENT)) {
+                return false;
+            }
+
+            a_Variable.NameIndex = m_Tokenizer.SymIndex();
+
+            sym = m_Tokenizer.Peek();
+            if (sym == flow::T_ASSIGN) {
+                m_Tokenizer.GetSym();
+                a_Variable.HasDefaultValue = 1;     // has a default value.
+
+                sym = m_Tokenizer.GetSym();
+                if (sym == T_REAL) {
+                    a_Variable.DefaultValue.fValue = m_Tokenizer.RealValue();
+                } else if (sym == T_INTEGER) {
+                    a_Variable.DefaultValue.fValue = static_cast<float>(m_Tokenizer.IntValue());
+                } else {
+                    return Unexpected(sym);
+                }
+            } else {
+                a_Variable.HasDefaultValue = 0;
+            }
+            // terminated with a semicolon
+            if (!Expect(T_SEMICOLON)) {
+                return false;
+            }
+        } else if (sym == flow::T_TYPE_BOOL) {
+            a_Variable.Type = FlowVariable::TYPE_BOOL;
+            // should be followed by a name.
+            if (!Expect(flow::T_IDENT)) {
+                return false;
+            }
+
+            a_Variable.NameIndex = m_Tokenizer.SymIndex();
+
+            sym = m_Tokenizer.Peek();
+            if (sym == flow::T_ASSIGN) {
+                m_Tokenizer.GetSym();
+                a_Variable.HasDefaultValue = 1;     // has a default value.
+
+                sym = m_Tokenizer.GetSym();
+                if (sym == T_KEYWORD_TRUE) {
+                    a_Variable.DefaultValue.bValue = true;
+                } else if(sym == T_KEYWORD_FALSE) {
+                    a_Variable.DefaultValue.bValue = false;
+                } else {
+                    return Unexpected(sym);
+                }
+            } else {
+                a_Variable.HasDefaultValue = 0;
+            }
+            // terminated with a semicolon
+            if (!Expect(T_SEMICOLON)) {
+                return false;
+            }
+        } else {
+            return Unexpected(sym);
+        }
+        return true;
+    }
+
+    /**
+     * \brief    A flow query can only contain output variables and events.
+     */
+    template<class Tokens>
+    template<class Definition>
+    constexpr bool Grammar<Tokens>::ParseQuery(Definition & a_Query)
+    {
+        if (!Expect(T_KEYWORD_QUERY)) {
+            return false;
+        }
+
+        if (!Expect(T_IDENT)) {
+            return false;
+        }
+
+        if (!a_Query.SetName(m_Tokenizer.SymIndex())) {
+            return false;
+        }
+
+        if (!Expect(T_LEFT_CURLY_BRACKET)) {
+            return false;
+        }
+
+        Symbol_t prefix = m_Tokenizer.Peek();
+
+        while(prefix == T_KEYWORD_OUT) {
+            m_Tokenizer.GetSym();   // consume 'out'
+            Symbol_t sym = m_Tokenizer.Peek();
+            if (sym == T_KEYWORD_EVENT) {
+                flow::FlowEvent ev = {};
+                if (!ParseEvent(ev)) {
+                    return false;
+                }
+                ev.Direction = FlowEvent::EVENT_OUT;
+                if (!a_Query.AddEvent(ev)) {
+                    return false;
+                }
+            } else {
+                flow::FlowVariable var = {};
+                if (!ParseVariable(var)) {
+                    return false;
+                }
+                var.HasDirection    = 1;
+                var.Direction       = FlowEvent::EVENT_OUT;
+                if (!a_Query.AddVariable(var)) {
+                    return false;
+                }
+            }
+            prefix = m_Tokenizer.Peek();
+        }
+        if (!Expect(T_RIGHT_CURLY_BRACKET)) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Parses a flow event declaration.
+     */
+    template<class Tokens>
+    constexpr bool Grammar<Tokens>::ParseEvent(FlowEvent & a_Event)
+    {
+        if (!Expect(T_KEYWORD_EVENT)) {    // should start with event.
+            return false;
+        }
+
+        if (!Expect(T_IDENT)) {
+            return false;
+        }
+
+        a_Event.NameIndex = m_Tokenizer.SymIndex();
+
+        if (!Expect(T_SEMICOLON)) {
+            return false;
+        }
+        return true;
+    }
+}
+
+#endif
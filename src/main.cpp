@@ -1,55 +1,50 @@
-#include "parser.h"
-
-#include <iostream>
-#include <string>
-
-const char * FlowDefinition =
-    "node SoundNode\n" 
-    "{\n"
-    "   in event Play;\n"
-    "   in event Stop;\n"
-    "   out event Playing;\n"
-    "   out event Stopped;\n"
-    "   bool boolean_value;\n"
-    "   float float_value = 1;\n"
-    "}\n"
-    "query Test\n"
-    "{\n"
-    "   out event Status;\n"
-    "   out event Play;\n"
-    "   out bool boolean_value;\n"
-    "}\n";
-
-int main()
-{
-    flow::FlowDocument  Document;
-    flow::Parser        parser;
-
-    if (!parser.Parse(FlowDefinition, Document)) {
-        std::cout << parser.GetErrorString() << std::endl;
-        return -1;
-    }
-
-    for(auto it = Document.Nodes.begin(); it != Document.Nodes.end(); it++) {
-        std::cout << "### Node: " << parser.GetString(it->NameIndex) << std::endl;
-        for(auto nit = it->Variables.begin(); nit != it->Variables.end(); nit++) {
-            std::cout <<"\tVariable: " << parser.GetString(nit->NameIndex) << std::endl;
-        }
-        for(auto nit = it->Events.begin(); nit != it->Events.end(); nit++) {
-            std::cout <<"\tEvent: " << parser.GetString(nit->NameIndex) << std::endl;
-        }
-    }
-
-    for(auto it = Document.Queries.begin(); it != Document.Queries.end(); it++) {
-        std::cout << "### Query: " << parser.GetString(it->NameIndex) << std::endl;
-        for(auto nit = it->Variables.begin(); nit != it->Variables.end(); nit++) {
-            std::cout <<"\tVariable: " << parser.GetString(nit->NameIndex) << std::endl;
-        }
-        for(auto nit = it->Events.begin(); nit != it->Events.end(); nit++) {
-            std::cout <<"\tEvent: " << parser.GetString(nit->NameIndex) << std::endl;
-        }
-    }
-
-
-    return 0;
+#include "static_document.h"
+
+#include <iostream>
+#include <string>
+
+static constexpr char FlowDefinition[] =
+    "node SoundNode\n" 
+    "{\n"
+    "   in event Play;\n"
+    "   in event Stop;\n"
+    "   out event Playing;\n"
+    "   out event Stopped;\n"
+    "   bool boolean_value;\n"
+    "   float float_value = 1;\n"
+    "}\n"
+    "query Test\n"
+    "{\n"
+    "   out event Status;\n"
+    "   out event Play;\n"
+    "   out bool boolean_value;\n"
+    "}\n";
+
+/** Parsed while compiling, nothing is tokenized or allocated for it at startup */
+FLOW_STATIC_DOCUMENT(BuiltinDocument, FlowDefinition);
+
+int main()
+{
+    for(auto it = BuiltinDocument.Nodes.begin(); it != BuiltinDocument.Nodes.end(); it++) {
+        std::cout << "### Node: " << BuiltinDocument.GetString(it->Name) << std::endl;
+        for(uint32_t i = 0; i < it->VariableCount; i++) {
+            std::cout <<"\tVariable: " << BuiltinDocument.GetString(BuiltinDocument.Variables[it->FirstVariable + i].Name) << std::endl;
+        }
+        for(uint32_t i = 0; i < it->EventCount; i++) {
+            std::cout <<"\tEvent: " << BuiltinDocument.GetString(BuiltinDocument.Events[it->FirstEvent + i].Name) << std::endl;
+        }
+    }
+
+    for(auto it = BuiltinDocument.Queries.begin(); it != BuiltinDocument.Queries.end(); it++) {
+        std::cout << "### Query: " << BuiltinDocument.GetString(it->Name) << std::endl;
+        for(uint32_t i = 0; i < it->VariableCount; i++) {
+            std::cout <<"\tVariable: " << BuiltinDocument.GetString(BuiltinDocument.Variables[it->FirstVariable + i].Name) << std::endl;
+        }
+        for(uint32_t i = 0; i < it->EventCount; i++) {
+            std::cout <<"\tEvent: " << BuiltinDocument.GetString(BuiltinDocument.Events[it->FirstEvent + i].Name) << std::endl;
+        }
+    }
+
+
+    return 0;
 }
\ No newline at end of file
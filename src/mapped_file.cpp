@@ -0,0 +1,171 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace flow
+{
+    MappedFile::MappedFile() : m_pData(nullptr), m_nSize(0), m_IsOpen(false)
+#ifdef _WIN32
+        , m_hFile(INVALID_HANDLE_VALUE), m_hMapping(nullptr)
+#endif
+    {
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const char * a_Path)
+    {
+        Close();
+        if (!a_Path) {
+            return false;
+        }
+        m_hFile = CreateFileA(a_Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        if (GetFileType(m_hFile) != FILE_TYPE_DISK) {
+            /** pipes and devices report no size, read them to the end */
+            char buffer[65536];
+            DWORD count = 0;
+            for(;;) {
+                if (!ReadFile(m_hFile, buffer, sizeof(buffer), &count, nullptr)) {
+                    if (GetLastError() == ERROR_BROKEN_PIPE) {
+                        break;  /** the writer closed the pipe */
+                    }
+                    Close();
+                    return false;
+                }
+                if (count == 0) {
+                    break;
+                }
+                m_Buffer.append(buffer, count);
+            }
+            m_pData     = m_Buffer.empty() ? nullptr : m_Buffer.data();
+            m_nSize     = m_Buffer.size();
+            m_IsOpen    = true;
+            return true;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_hFile, &size)) {
+            Close();
+            return false;
+        }
+        m_nSize = static_cast<size_t>(size.QuadPart);
+        if (m_nSize > 0) {  /** empty files can't be mapped */
+            m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_hMapping) {
+                Close();
+                return false;
+            }
+            m_pData = static_cast<const char *>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+            if (!m_pData) {
+                Close();
+                return false;
+            }
+        }
+        m_IsOpen = true;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_pData && m_Buffer.empty()) {
+            UnmapViewOfFile(m_pData);
+        }
+        if (m_hMapping) {
+            CloseHandle(m_hMapping);
+        }
+        if (m_hFile != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_hFile);
+        }
+        m_pData     = nullptr;
+        m_nSize     = 0;
+        m_IsOpen    = false;
+        m_hMapping  = nullptr;
+        m_hFile     = INVALID_HANDLE_VALUE;
+        m_Buffer.clear();
+    }
+#else
+    bool MappedFile::Open(const char * a_Path)
+    {
+        Close();
+        if (!a_Path) {
+            return false;
+        }
+        int fd = open(a_Path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            close(fd);
+            return false;
+        }
+        if (!S_ISREG(st.st_mode)) {
+            /** pipes and devices report no size, read them to the end */
+            char buffer[65536];
+            ssize_t count;
+            while((count = read(fd, buffer, sizeof(buffer))) != 0) {
+                if (count < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    close(fd);
+                    m_Buffer.clear();
+                    return false;
+                }
+                m_Buffer.append(buffer, static_cast<size_t>(count));
+            }
+            close(fd);
+            m_pData     = m_Buffer.empty() ? nullptr : m_Buffer.data();
+            m_nSize     = m_Buffer.size();
+            m_IsOpen    = true;
+            return true;
+        }
+        m_nSize = static_cast<size_t>(st.st_size);
+        if (m_nSize > 0) {  /** empty files can't be mapped */
+            void * ptr = mmap(nullptr, m_nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) {
+                close(fd);
+                m_nSize = 0;
+                return false;
+            }
+            /** the tokenizer reads the mapping front to back */
+            madvise(ptr, m_nSize, MADV_SEQUENTIAL);
+            m_pData = static_cast<const char *>(ptr);
+        }
+        close(fd);  /** the mapping keeps its own reference to the file */
+        m_IsOpen = true;
+        return true;
+    }
+
+    void MappedFile::Close()
+    {
+        if (m_pData && m_Buffer.empty()) {
+            munmap(const_cast<char *>(m_pData), m_nSize);
+        }
+        m_pData     = nullptr;
+        m_nSize     = 0;
+        m_IsOpen    = false;
+        m_Buffer.clear();
+    }
+#endif
+}
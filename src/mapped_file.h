@@ -0,0 +1,48 @@
+#ifndef _FLOW_MAPPED_FILE_H_
+#define _FLOW_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace flow
+{
+    /**
+     * \brief   A file mapped read-only into memory.
+     *
+     * Files that can't be mapped, such as pipes and character devices, are read into a
+     * buffer instead, so the contents are available the same way.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        /**
+         * \brief   Maps the file at the specified path, closing any previous mapping.
+         *
+         * \return  true if the file was mapped successfully, or false otherwise.
+         */
+        bool Open(const char * a_Path);
+        void Close();
+
+        const char *    Data() const        {return m_pData;}
+        size_t          Size() const        {return m_nSize;}
+        bool            IsOpen() const      {return m_IsOpen;}
+
+    protected:
+        MappedFile(const MappedFile &);
+        MappedFile & operator=(const MappedFile &);
+
+        const char *    m_pData;
+        size_t          m_nSize;
+        bool            m_IsOpen;
+        std::string     m_Buffer;       /**< Contents of a file that isn't mapped */
+#ifdef _WIN32
+        void *          m_hFile;
+        void *          m_hMapping;
+#endif
+    };
+}
+
+#endif
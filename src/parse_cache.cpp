@@ -0,0 +1,198 @@
+#include "parse_cache.h"
+#include "mapped_file.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace flow
+{
+    static const uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+    static const uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    static const uint64_t Prime3 = 0x165667B19E3779F9ULL;
+    static const uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+    static const uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+    static inline uint64_t RotateLeft(uint64_t a_Value, int a_Bits)
+    {
+        return (a_Value << a_Bits) | (a_Value >> (64 - a_Bits));
+    }
+
+    static inline uint64_t Read64(const unsigned char * a_Ptr)
+    {
+        uint64_t value;
+        memcpy(&value, a_Ptr, sizeof(value));
+        return value;
+    }
+
+    static inline uint32_t Read32(const unsigned char * a_Ptr)
+    {
+        uint32_t value;
+        memcpy(&value, a_Ptr, sizeof(value));
+        return value;
+    }
+
+    static inline uint64_t Round(uint64_t a_Acc, uint64_t a_Input)
+    {
+        a_Acc += a_Input * Prime2;
+        a_Acc = RotateLeft(a_Acc, 31);
+        return a_Acc * Prime1;
+    }
+
+    static inline uint64_t MergeRound(uint64_t a_Acc, uint64_t a_Value)
+    {
+        a_Acc ^= Round(0, a_Value);
+        return a_Acc * Prime1 + Prime4;
+    }
+
+    uint64_t HashBytes(const void * a_Data, size_t a_Size, uint64_t a_Seed)
+    {
+        const unsigned char * p     = static_cast<const unsigned char *>(a_Data);
+        const unsigned char * end   = p + a_Size;
+        uint64_t hash;
+
+        if (a_Size >= 32) {
+            /** four independent lanes keep the multipliers busy */
+            uint64_t v1 = a_Seed + Prime1 + Prime2;
+            uint64_t v2 = a_Seed + Prime2;
+            uint64_t v3 = a_Seed;
+            uint64_t v4 = a_Seed - Prime1;
+            const unsigned char * limit = end - 32;
+            do {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            hash = MergeRound(hash, v1);
+            hash = MergeRound(hash, v2);
+            hash = MergeRound(hash, v3);
+            hash = MergeRound(hash, v4);
+        } else {
+            hash = a_Seed + Prime5;
+        }
+
+        hash += static_cast<uint64_t>(a_Size);
+        for(; p + 8 <= end; p += 8) {
+            hash ^= Round(0, Read64(p));
+            hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+        }
+        if (p + 4 <= end) {
+            hash ^= static_cast<uint64_t>(Read32(p)) * Prime1;
+            hash = RotateLeft(hash, 23) * Prime2 + Prime3;
+            p += 4;
+        }
+        for(; p < end; ++p) {
+            hash ^= (*p) * Prime5;
+            hash = RotateLeft(hash, 11) * Prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= Prime2;
+        hash ^= hash >> 29;
+        hash *= Prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    ParseCache::ParseCache(const std::string & a_Directory) : m_Directory(a_Directory), m_nHits(0), m_nMisses(0)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_Directory, error);
+    }
+
+    std::string ParseCache::GetCachePath(const char * a_Data, size_t a_Size) const
+    {
+        /** the length is part of the key, so sources of different lengths never share an entry */
+        char name[64];
+        snprintf(name, sizeof(name), "%016llx-%llx.flowc", 
+            static_cast<unsigned long long>(HashBytes(a_Data, a_Size, CompiledFormatVersion)), static_cast<unsigned long long>(a_Size));
+        return (std::filesystem::path(m_Directory) / name).string();
+    }
+
+    bool ParseCache::Parse(const std::string & a_Source, CompiledDocument & a_Document)
+    {
+        return Parse(a_Source.data(), a_Source.size(), a_Document);
+    }
+
+    bool ParseCache::ParseFile(const char * a_Path, CompiledDocument & a_Document)
+    {
+        if (!a_Path) {
+            m_ErrorString = "FAILED TO OPEN";
+            return false;
+        }
+        MappedFile file;
+        if (!file.Open(a_Path)) {
+            m_ErrorString = std::string("FAILED TO OPEN ") + a_Path;
+            return false;
+        }
+        return Parse(file.Data(), file.Size(), a_Document);
+    }
+
+    bool ParseCache::Parse(const char * a_Data, size_t a_Size, CompiledDocument & a_Document)
+    {
+        m_ErrorString = "";
+        std::string path = GetCachePath(a_Data, a_Size);
+
+        /** a missing, corrupt or outdated entry is simply a miss */
+        if (a_Document.LoadFile(path.c_str())) {
+            ++m_nHits;
+            return true;
+        }
+        ++m_nMisses;
+
+        /** the names are copied into the blob, so the parser doesn't need to remember them */
+        m_Parser.Reset();
+        m_Document.Clear();
+        if (!m_Parser.Parse(a_Data, a_Size, m_Document)) {
+            m_ErrorString = m_Parser.GetErrorString();
+            return false;
+        }
+        std::vector<char> blob;
+        if (!CompileDocument(m_Document, m_Parser.GetSymbolTable(), blob)) {
+            m_ErrorString = "DOCUMENT TOO LARGE";
+            return false;
+        }
+
+        /** failing to store only costs the next caller a parse */
+        Store(path, blob);
+        if (!a_Document.LoadBlob(std::move(blob))) {
+            m_ErrorString = a_Document.GetErrorString();
+            return false;
+        }
+        return true;
+    }
+
+    bool ParseCache::Store(const std::string & a_Path, const std::vector<char> & a_Blob)
+    {
+        static std::atomic<unsigned> s_nCounter(0);
+        char suffix[48];
+        snprintf(suffix, sizeof(suffix), ".%zx.%x.tmp", 
+            std::hash<std::thread::id>()(std::this_thread::get_id()), s_nCounter.fetch_add(1));
+        std::string temp = a_Path + suffix;
+
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out.write(a_Blob.data(), static_cast<std::streamsize>(a_Blob.size())) || !out.flush()) {
+                out.close();
+                std::remove(temp.c_str());
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temp, a_Path, error);
+        if (error) {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef _FLOW_PARSE_CACHE_H_
+#define _FLOW_PARSE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "compiled.h"
+#include "parser.h"
+
+namespace flow
+{
+    /**
+     * \brief   64-bit non-cryptographic hash of a byte range, compatible with XXH64.
+     */
+    uint64_t HashBytes(const void * a_Data, size_t a_Size, uint64_t a_Seed = 0);
+
+    /**
+     * \brief   Keeps compiled documents in a directory, keyed by a hash of their source.
+     *
+     * A source that was parsed before is loaded straight from its compiled file instead of
+     * being parsed again. The key is the hash and length of the source and includes the 
+     * compiled format version, so entries written by another version are never found and are
+     * parsed and replaced like any other miss.
+     */
+    class ParseCache
+    {
+    public:
+        /**
+         * \brief   Creates a cache in the specified directory, creating the directory if needed.
+         */
+        ParseCache(const std::string & a_Directory);
+
+        /**
+         * \brief   Returns the compiled document of the source, parsing and storing it on a miss.
+         *
+         * \return  true if the document is available, or false if the source failed to parse.
+         */
+        bool Parse(const char * a_Data, size_t a_Size, CompiledDocument & a_Document);
+        bool Parse(const std::string & a_Source, CompiledDocument & a_Document);
+        bool ParseFile(const char * a_Path, CompiledDocument & a_Document);
+
+        /**
+         * \brief   Returns the path of the cache file for the specified source.
+         */
+        std::string GetCachePath(const char * a_Data, size_t a_Size) const;
+
+        const std::string & GetErrorString() const  {return m_ErrorString;}
+        const std::string & GetDirectory() const    {return m_Directory;}
+        size_t              Hits() const            {return m_nHits;}
+        size_t              Misses() const          {return m_nMisses;}
+
+    protected:
+        ParseCache(const ParseCache &);
+        ParseCache & operator=(const ParseCache &);
+
+        /**
+         * \brief   Writes the blob to a temporary file and renames it into place, so readers 
+         *          never see a partially written entry.
+         */
+        bool Store(const std::string & a_Path, const std::vector<char> & a_Blob);
+
+        std::string     m_Directory;
+        Parser          m_Parser;
+        FlowDocument    m_Document;     /**< Reused by every miss */
+        size_t          m_nHits;
+        size_t          m_nMisses;
+        std::string     m_ErrorString;
+    };
+}
+
+#endif
@@ -1,310 +1,954 @@
-#include "parser.h"
-#include "token.h"
-
-#include <sstream>
-
-namespace flow
-{
-    /** 
-     * \brief   Parses a document containing flow definitions.
-     * \param   a_String    The document as a string.
-     * \param   a_Document  The document as a string.
-     *
-     * \return  true if the document was parsed successfully, or false otherwise.
-     */
-    bool Parser::Parse(const std::string & a_String, FlowDocument & a_Document)
-    {
-        m_ErrorString = "";
-        std::stringstream ss(a_String);
-        flow::Tokenizer token(ss);
-        return ParseDocument(token, a_Document);
-    }
-
-    /**
-     * \brief   Internal implementation of the parsing that uses a tokenizer.
-     */
-    bool Parser::ParseDocument(flow::Tokenizer & a_Tokenizer, FlowDocument & a_Document)
-    {
-        Symbol_t sym = a_Tokenizer.Peek();
-        while( sym != flow::T_EOF ) 
-        {
-            if (sym == flow::T_KEYWORD_NODE) {
-                FlowNode node;
-                if (!ParseNode(a_Tokenizer, node)) {
-                    return false;
-                }
-                a_Document.Nodes.push_back(node);
-            } else if (sym == flow::T_KEYWORD_QUERY) {
-                FlowQuery query;
-                if (!ParseQuery(a_Tokenizer, query)) {
-                    return false;
-                }
-                a_Document.Queries.push_back(query);
-            } else {
-                Unexpected(sym, a_Tokenizer.Position());
-                return false;
-            }
-            sym = a_Tokenizer.Peek();
-        }
-        return true;
-    }
-
-    /**
-     * \brief   Parses a flow node definition.
-     */
-    bool Parser::ParseNode(flow::Tokenizer & a_Tokenizer, FlowNode & a_Node)
-    {
-        if (!Expect(T_KEYWORD_NODE, a_Tokenizer)) {
-            return false;
-        }
-
-        if (!Expect(T_IDENT, a_Tokenizer)) {
-            return false;
-        }
-
-        if (!InsertName(a_Tokenizer.Lookup(a_Tokenizer.SymIndex()), &a_Node.NameIndex)) {
-            return false;
-        }
-
-        if (!Expect(T_LEFT_CURLY_BRACKET, a_Tokenizer)) {
-            return false;
-        }
-
-        Symbol_t prefix = a_Tokenizer.Peek();
-
-        for(;;) {
-            if ((prefix == flow::T_TYPE_FLOAT) || (prefix == flow::T_TYPE_BOOL)) {
-                /** Variable declaration without prefix */
-                FlowVariable variable;
-                if (!ParseVariable(a_Tokenizer, variable)) {
-                    return false;
-                }
-                a_Node.Variables.push_back(variable);
-            } else if ((prefix == flow::T_KEYWORD_IN) || (prefix == flow::T_KEYWORD_OUT)) {
-                a_Tokenizer.GetSym();   // consume.
-                Symbol_t sym = a_Tokenizer.Peek();
-                if ((sym == flow::T_TYPE_BOOL) || (sym == flow::T_TYPE_FLOAT)) {
-                    FlowVariable variable;
-                    if (!ParseVariable(a_Tokenizer, variable)) {
-                        return false;
-                    }
-                    variable.HasDirection = 1;
-                    variable.Direction = (prefix == flow::T_KEYWORD_IN) ? flow::FlowEvent::EVENT_IN : flow::FlowEvent::EVENT_OUT;
-                    a_Node.Variables.push_back(variable);
-                } else {
-                    // should be a event.
-                    FlowEvent ev;
-                    if (!ParseEvent(a_Tokenizer, ev)) {
-                        return false;
-                    }
-                    ev.Direction = (prefix == flow::T_KEYWORD_IN) ? flow::FlowEvent::EVENT_IN : flow::FlowEvent::EVENT_OUT;
-                    a_Node.Events.push_back(ev);
-                }
-            } else {
-                break;
-            }
-            prefix = a_Tokenizer.Peek();
-        }
-
-        if (!Expect(T_RIGHT_CURLY_BRACKET, a_Tokenizer)) {
-            return false;
-        }
-        return true;
-    }
-
-    /**
-     * \brief   Parses a variable declaration.
-     */
-    bool Parser::ParseVariable(flow::Tokenizer & a_Tokenizer, FlowVariable & a_Variable)
-    {
-        Symbol_t sym = a_Tokenizer.GetSym();
-        if (sym == flow::T_TYPE_FLOAT) {
-            a_Variable.Type = FlowVariable::TYPE_FLOAT;
-            // should be followed by a name.
-            if (!Expect(flow::T_IDENT, a_Tokenizer)) {
-                return false;
-            }
-
-            if (!InsertName(a_Tokenizer.Lookup(a_Tokenizer.SymIndex()), &a_Variable.NameIndex)) {
-                return false;
-            }
-
-            sym = a_Tokenizer.Peek();   
-            if (sym == flow::T_ASSIGN) {
-                a_Tokenizer.GetSym();
-                a_Variable.HasDefaultValue = 1;     // has a default value.
-
-                sym = a_Tokenizer.GetSym();
-                if (sym == T_REAL) {
-                    a_Variable.DefaultValue.fValue = a_Tokenizer.RealValue();
-                } else if (sym == T_INTEGER) {
-                    a_Variable.DefaultValue.fValue = static_cast<float>(a_Tokenizer.IntValue());
-                } else {
-                    Unexpected(sym, a_Tokenizer.Position());
-                }
-            } else {
-                a_Variable.HasDefaultValue = 0;
-            }
-            // terminated with a semicolon
-            if (!Expect(T_SEMICOLON, a_Tokenizer)) {
-                return false;
-            }
-        } else if (sym == flow::T_TYPE_BOOL) {
-            a_Variable.Type = FlowVariable::TYPE_BOOL;
-            // should be followed by a name.
-            if (!Expect(flow::T_IDENT, a_Tokenizer)) {
-                return false;
-            }
-
-            if (!InsertName(a_Tokenizer.Lookup(a_Tokenizer.SymIndex()), &a_Variable.NameIndex)) {
-                return false;
-            }
-
-            sym = a_Tokenizer.Peek();   
-            if (sym == flow::T_ASSIGN) {
-                a_Tokenizer.GetSym();
-                a_Variable.HasDefaultValue = 1;     // has a default value.
-
-                sym = a_Tokenizer.GetSym();
-                if (sym == T_KEYWORD_TRUE) {
-                    a_Variable.DefaultValue.bValue = true;
-                } else if(sym == T_KEYWORD_FALSE) {
-                    a_Variable.DefaultValue.bValue = false;
-                } else {
-                    Unexpected(sym, a_Tokenizer.Position());
-                    return false;
-                }
-            } else {
-                a_Variable.HasDefaultValue = 0;
-            }
-            // terminated with a semicolon
-            if (!Expect(T_SEMICOLON, a_Tokenizer)) {
-                return false;
-            }
-        } else {
-            Unexpected(sym, a_Tokenizer.Position());
-            return false;
-        }
-        return true;
-    }
-
-    /**
-     * \brief    A flow query can only contain output variables and events.
-     */
-    bool Parser::ParseQuery(flow::Tokenizer & a_Tokenizer, FlowQuery & a_Query)
-    {
-        if (!Expect(T_KEYWORD_QUERY, a_Tokenizer)) {
-            return false;
-        }
-
-        if (!Expect(T_IDENT, a_Tokenizer)) {
-            return false;
-        }
-
-        if (!InsertName(a_Tokenizer.Lookup(a_Tokenizer.SymIndex()), &a_Query.NameIndex)) {
-            return false;
-        }
-
-        if (!Expect(T_LEFT_CURLY_BRACKET, a_Tokenizer)) {
-            return false;
-        }
-
-        Symbol_t prefix = a_Tokenizer.Peek();
-
-        while(prefix == T_KEYWORD_OUT) {
-            a_Tokenizer.GetSym();   // consume 'out'
-            Symbol_t sym = a_Tokenizer.Peek();
-            if (sym == T_KEYWORD_EVENT) {
-                flow::FlowEvent ev;
-                if (!ParseEvent(a_Tokenizer, ev)) {
-                    return false;
-                }
-                ev.Direction = FlowEvent::EVENT_OUT;
-                a_Query.Events.push_back(ev);
-            } else {
-                flow::FlowVariable var;
-                if (!ParseVariable(a_Tokenizer, var)) {
-                    return false;
-                }
-                var.HasDirection    = 1;
-                var.Direction       = FlowEvent::EVENT_OUT;
-                a_Query.Variables.push_back(var);
-            }
-            prefix = a_Tokenizer.Peek();
-        }
-        if (!Expect(T_RIGHT_CURLY_BRACKET, a_Tokenizer)) {
-            return false;
-        }
-        return true;
-    }
-
-    /**
-     * \brief   Parses a flow event declaration.
-     */
-    bool Parser::ParseEvent(flow::Tokenizer & a_Tokenizer, FlowEvent & a_Event)
-    {
-        if (!Expect(T_KEYWORD_EVENT, a_Tokenizer)) {    // should start with event.
-            return false;
-        }
-
-        if (!Expect(T_IDENT, a_Tokenizer)) {
-            return false;
-        }
-
-        if (!InsertName(a_Tokenizer.Lookup(a_Tokenizer.SymIndex()), &a_Event.NameIndex)) {
-            return false;
-        }
-
-        if (!Expect(T_SEMICOLON, a_Tokenizer)) {
-            return false;
-        }
-
-        return true;
-    }
-
-    std::ostream & operator << (std::ostream & os, const PositionInfo & pos) 
-    {
-        os << "(Ln: " << pos.Row << ", Col: " << pos.Col << ")";
-        return os;
-    }
-
-    bool Parser::Expect(Symbol_t a_Expected, flow::Tokenizer & a_Tokenizer)
-    {
-        Symbol_t actual = a_Tokenizer.GetSym();
-        if (actual != a_Expected) {
-            std::stringstream err;
-            err << "EXPECTED " << flow::Tokenizer::GetTokenString(a_Expected) << " at " << a_Tokenizer.Position() 
-                << ", actual " <<  flow::Tokenizer::GetTokenString(actual);
-            m_ErrorString = err.str();
-            return false;
-        }
-        return true;
-    }
-
-    void Parser::Unexpected(Symbol_t a_Sym, const flow::PositionInfo & a_Position)
-    {
-        std::stringstream err;
-        err << "UNEXPECTED " << flow::Tokenizer::GetTokenString(a_Sym) << " at " << a_Position;
-        m_ErrorString = err.str();
-    }
-
-    bool Parser::InsertName(const char * a_String, size_t * a_NameIndex)
-    {
-        if (!a_String || !a_NameIndex) {
-            return false;
-        }
-
-        *a_NameIndex = m_StringPool.Insert(a_String, strlen(a_String) + 1); // remember the null terminator
-        return true;
-    }
-
-    const std::string & Parser::GetErrorString() const 
-    {
-        return m_ErrorString;
-    }
-
-    const char * Parser::GetString(size_t a_Index) const
-    {
-        return m_StringPool.GetPointer(a_Index);
-    }
+#include "parser.h"
+#include "document_index.h"
+#include "grammar.h"
+#include "token.h"
+#include "mapped_file.h"
+#include "scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace flow
+{
+    /**
+     * \brief   Fills a FlowNode or FlowQuery of a document, the events and variables that 
+     *          spill out of the definition are allocated from the document's storage. With
+     *          an index the names are added to it as they are parsed.
+     */
+    template<class Definition>
+    struct DocumentDefinition
+    {
+        DocumentDefinition(Definition & a_Definition, Arena & a_Storage, DocumentIndex * a_pIndex = nullptr, size_t a_Position = 0) : 
+            Target(a_Definition), Storage(a_Storage), Index(a_pIndex), Position(static_cast<uint32_t>(a_Position))
+        {
+        }
+
+        static const bool IsQuery = std::is_same<Definition, FlowQuery>::value;
+
+        /** The builders return false to stop the parse, which only a handler does */
+        bool SetName(SymbolTable::SymIndex a_Name)
+        {
+            Target.NameIndex = a_Name;
+            if (Index) {
+                Index->AddDefinition(IsQuery, Position, a_Name);
+            }
+            return true;
+        }
+
+        bool AddEvent(const FlowEvent & a_Event)
+        {
+            if (Index) {
+                Index->AddMember(IsQuery, Position, Target.NameIndex, false, static_cast<uint32_t>(Target.Events.size()), a_Event.NameIndex);
+            }
+            Target.Events.push_back(a_Event, Storage);
+            return true;
+        }
+
+        bool AddVariable(const FlowVariable & a_Variable)
+        {
+            if (Index) {
+                Index->AddMember(IsQuery, Position, Target.NameIndex, true, static_cast<uint32_t>(Target.Variables.size()), a_Variable.NameIndex);
+            }
+            Target.Variables.push_back(a_Variable, Storage);
+            return true;
+        }
+
+        Definition &        Target;
+        Arena &             Storage;
+        DocumentIndex *     Index;
+        uint32_t            Position;   /**< Of the definition in the document's Nodes or Queries */
+    };
+
+    /**
+     * \brief   Makes room for a_Count elements in a vector that is appended to, growing at least
+     *          geometrically so that appending many small documents doesn't copy on every parse.
+     */
+    template<class T>
+    static void ReserveAppend(std::vector<T> & a_Vector, size_t a_Count)
+    {
+        if (a_Vector.capacity() < a_Count) {
+            a_Vector.reserve(std::max(2 * a_Vector.capacity(), a_Count));
+        }
+    }
+
+    /**
+     * \brief   Moves a definition by swapping its lists, so lists in the document's storage keep
+     *          their buffers instead of being copied to the heap as a move would.
+     */
+    template<class Definition>
+    static void SwapDefinitions(Definition & a_Left, Definition & a_Right)
+    {
+        std::swap(a_Left.NameIndex, a_Right.NameIndex);
+        a_Left.Events.swap(a_Right.Events);
+        a_Left.Variables.swap(a_Right.Variables);
+    }
+
+    /**
+     * \brief   ReserveAppend() for the definitions of a FlowDocument, which are moved by swapping.
+     */
+    template<class Definition>
+    static void ReserveDefinitions(std::vector<Definition> & a_Definitions, size_t a_Count)
+    {
+        if (a_Definitions.capacity() < a_Count) {
+            std::vector<Definition> grown;
+            grown.reserve(std::max(2 * a_Definitions.capacity(), a_Count));
+            grown.resize(a_Definitions.size());
+            for(size_t i = 0; i < a_Definitions.size(); ++i) {
+                SwapDefinitions(grown[i], a_Definitions[i]);
+            }
+            a_Definitions.swap(grown);
+        }
+    }
+
+    /**
+     * \brief   Moves the spilled members of definitions to memory from an arena.
+     */
+    template<class Definition>
+    static void RelocateDefinitions(std::vector<Definition> & a_Definitions, Arena & a_Arena)
+    {
+        for(Definition & definition : a_Definitions) {
+            definition.Events.relocate(a_Arena);
+            definition.Variables.relocate(a_Arena);
+        }
+    }
+
+    /** Bytes of an arena a list holds */
+    template<class List>
+    static size_t SpilledBytes(const List & a_List)
+    {
+        return a_List.is_arena() ? a_List.capacity() * sizeof(typename List::value_type) : 0;
+    }
+
+    /**
+     * \brief   Replaces a_Count definitions of a document from a_Position on with a_Parsed,
+     *          moving the definitions by swapping. a_Parsed is left with moved-from definitions.
+     */
+    template<class Definition>
+    static void SpliceDefinitions(std::vector<Definition> & a_Definitions, size_t a_Position, size_t a_Count, std::vector<Definition> & a_Parsed)
+    {
+        size_t size = a_Definitions.size(), parsed = a_Parsed.size();
+        if (parsed > a_Count) {
+            ReserveDefinitions(a_Definitions, size + parsed - a_Count);
+            a_Definitions.resize(size + parsed - a_Count);
+            for(size_t i = size; i > a_Position + a_Count; --i) {
+                SwapDefinitions(a_Definitions[i - 1], a_Definitions[i - 1 + parsed - a_Count]);
+            }
+        } else if (parsed < a_Count) {
+            for(size_t i = a_Position + a_Count; i < size; ++i) {
+                SwapDefinitions(a_Definitions[i - (a_Count - parsed)], a_Definitions[i]);
+            }
+            a_Definitions.resize(size - (a_Count - parsed));
+        }
+        for(size_t i = 0; i < parsed; ++i) {
+            SwapDefinitions(a_Definitions[a_Position + i], a_Parsed[i]);
+        }
+    }
+
+    Parser::Parser() : m_nNodeHint(0), m_nQueryHint(0), m_nEventHint(0), m_nVariableHint(0), m_nRowOffset(0), m_nColumnOffset(0)
+    {
+    }
+
+    /** 
+     * \brief   Parses a document containing flow definitions.
+     * \param   a_String    The document as a string.
+     * \param   a_Document  The document as a string.
+     *
+     * \return  true if the document was parsed successfully, or false otherwise.
+     */
+    bool Parser::Parse(const std::string & a_String, FlowDocument & a_Document)
+    {
+        return Parse(a_String.data(), a_String.size(), a_Document);
+    }
+
+    /** 
+     * \brief   Parses a document held in a buffer, without copying it.
+     */
+    bool Parser::Parse(const char * a_Data, size_t a_Size, FlowDocument & a_Document)
+    {
+        if (!Lex(a_Data, a_Size, m_Tokens)) {
+            return false;
+        }
+        return Parse(m_Tokens, a_Document);
+    }
+
+    /** 
+     * \brief   Parses a document and indexes its definitions in the same pass.
+     */
+    bool Parser::Parse(const char * a_Data, size_t a_Size, FlowDocument & a_Document, DocumentIndex & a_Index)
+    {
+        /** definitions already in the document are indexed up front, the parsed ones as they are parsed */
+        a_Index.Build(a_Document, m_SymbolTable);
+        if (!Lex(a_Data, a_Size, m_Tokens)) {
+            return false;
+        }
+        if (!ParseTokens(m_Tokens, a_Document, &a_Index)) {
+            /** a definition that failed to parse was added to the index but isn't in the document */
+            a_Index.Build(a_Document, m_SymbolTable);
+            return false;
+        }
+        if (!a_Index.Commit(m_SymbolTable)) {
+            m_ErrorString = a_Index.GetErrorString();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Returns true if a node or query keyword starts at p.
+     */
+    static bool IsDefinitionStart(const char * p, const char * end)
+    {
+        size_t length;
+        if ((end - p >= 4) && (memcmp(p, "node", 4) == 0)) {
+            length = 4;
+        } else if ((end - p >= 5) && (memcmp(p, "query", 5) == 0)) {
+            length = 5;
+        } else {
+            return false;
+        }
+        return (p + length == end) || (ScanIdentifier(p + length, end) == p + length);
+    }
+
+    /**
+     * \brief   Splits a document into at most a_Count parts that each start at a top-level 
+     *          definition. The offsets start with 0 and end with a_Size.
+     *
+     * Only braces are tracked, a part starts after a '}' that closes the outermost level 
+     * and is followed by a node or query keyword.
+     */
+    static void SplitDocument(const char * a_Data, size_t a_Size, size_t a_Count, std::vector<size_t> & a_Boundaries)
+    {
+        a_Boundaries.clear();
+        a_Boundaries.push_back(0);
+        const char * p = a_Data, * end = a_Data + a_Size;
+        size_t depth = 0;
+        for(size_t i = 1; (i < a_Count) && (p != end); ++i) {
+            const char * target = a_Data + (a_Size / a_Count) * i;
+            while(p != end) {
+                p = ScanBrace(p, end);
+                if (p == end) {
+                    break;
+                }
+                bool closed = false;
+                if (*p == '{') {
+                    ++depth;
+                } else if (depth > 0) {
+                    closed = (--depth == 0);
+                }
+                ++p;
+                if (closed && (p >= target)) {
+                    const char * next = ScanWhitespace(p, end);
+                    if (IsDefinitionStart(next, end)) {
+                        a_Boundaries.push_back(next - a_Data);
+                        break;
+                    }
+                }
+            }
+        }
+        a_Boundaries.push_back(a_Size);
+    }
+
+    /**
+     * \brief   Rewrites every name in the document through a symbol index mapping.
+     */
+    void RemapNames(FlowDocument & a_Document, const std::vector<SymbolTable::SymIndex> & a_Map)
+    {
+        for(FlowNode & node : a_Document.Nodes) {
+            node.NameIndex = a_Map[node.NameIndex];
+            for(FlowEvent & ev : node.Events) {
+                ev.NameIndex = a_Map[ev.NameIndex];
+            }
+            for(FlowVariable & var : node.Variables) {
+                var.NameIndex = a_Map[var.NameIndex];
+            }
+        }
+        for(FlowQuery & query : a_Document.Queries) {
+            query.NameIndex = a_Map[query.NameIndex];
+            for(FlowEvent & ev : query.Events) {
+                ev.NameIndex = a_Map[ev.NameIndex];
+            }
+            for(FlowVariable & var : query.Variables) {
+                var.NameIndex = a_Map[var.NameIndex];
+            }
+        }
+    }
+
+    /** 
+     * \brief   Parses a large document on several threads.
+     *
+     * If every part parses successfully the serial parse would have as well, since each part
+     * starts where the serial parser is between two definitions. Any failure falls back to 
+     * the serial parse, which produces the exact same error message and partial document.
+     */
+    bool Parser::ParseParallel(const char * a_Data, size_t a_Size, FlowDocument & a_Document, unsigned a_Threads)
+    {
+        /** below this the threads cost more than they save */
+        static const size_t MinPartSize = 256 * 1024;
+
+        if (a_Threads == 0) {
+            a_Threads = std::thread::hardware_concurrency();
+        }
+        size_t parts = a_Size / MinPartSize;
+        if (parts > static_cast<size_t>(a_Threads) * 4) {
+            parts = static_cast<size_t>(a_Threads) * 4;   /** a few parts per thread balances uneven parts */
+        }
+        if ((a_Threads <= 1) || (parts <= 1)) {
+            return Parse(a_Data, a_Size, a_Document);
+        }
+
+        std::vector<size_t> boundaries;
+        SplitDocument(a_Data, a_Size, parts, boundaries);
+        parts = boundaries.size() - 1;
+        if (parts <= 1) {
+            return Parse(a_Data, a_Size, a_Document);
+        }
+
+        struct Part {
+            flow::Parser        Parser;
+            FlowDocument        Document;
+            bool                Success;
+        };
+        std::vector<std::unique_ptr<Part>> results(parts);
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for(size_t i = next++; i < parts; i = next++) {
+                results[i].reset(new Part);
+                results[i]->Success = results[i]->Parser.Parse(a_Data + boundaries[i], boundaries[i + 1] - boundaries[i], 
+                    results[i]->Document);
+            }
+        };
+        std::vector<std::thread> threads;
+        size_t threadCount = (parts < a_Threads) ? parts : a_Threads;
+        for(size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for(std::thread & thread : threads) {
+            thread.join();
+        }
+
+        for(const std::unique_ptr<Part> & part : results) {
+            if (!part->Success) {
+                return Parse(a_Data, a_Size, a_Document);
+            }
+        }
+
+        /** merging in document order interns the names in the same order as a serial parse */
+        m_ErrorString = "";
+        std::vector<SymbolTable::SymIndex> map;
+        for(size_t part = 0; part < parts; ++part) {
+            FlowDocument & document = results[part]->Document;
+            const flow::SymbolTable & table = results[part]->Parser.GetSymbolTable();
+            map.resize(table.Size());
+            for(size_t i = 0; i < table.Size(); ++i) {
+                map[i] = m_SymbolTable.Insert(table.Retrive(static_cast<SymbolTable::SymIndex>(i)), table.Length(static_cast<SymbolTable::SymIndex>(i)));
+                if (map[i] == SymbolTable::InvalidIndex) {
+                    m_ErrorString = "OUT OF MEMORY";
+                    return false;
+                }
+            }
+            RemapNames(document, map);
+            for(FlowSpan span : document.Spans) {
+                span.Index  += static_cast<uint32_t>(span.IsQuery ? a_Document.Queries.size() : a_Document.Nodes.size());
+                span.Begin  += boundaries[part];
+                span.End    += boundaries[part];
+                a_Document.Spans.push_back(span);
+            }
+            /** the part's storage goes away with the part */
+            RelocateDefinitions(document.Nodes, a_Document.Storage);
+            RelocateDefinitions(document.Queries, a_Document.Storage);
+            SpliceDefinitions(a_Document.Nodes, a_Document.Nodes.size(), 0, document.Nodes);
+            SpliceDefinitions(a_Document.Queries, a_Document.Queries.size(), 0, document.Queries);
+        }
+        return true;
+    }
+
+    /** 
+     * \brief   Parses a document into the flat representation.
+     */
+    bool Parser::Parse(const char * a_Data, size_t a_Size, FlatDocument & a_Document)
+    {
+        if (!Lex(a_Data, a_Size, m_Tokens)) {
+            return false;
+        }
+        return Parse(m_Tokens, a_Document);
+    }
+
+    bool Parser::ParseFile(const char * a_Path, FlatDocument & a_Document)
+    {
+        flow::MappedFile file;
+        if (!file.Open(a_Path)) {
+            m_ErrorString = std::string("FAILED TO OPEN ") + (a_Path ? a_Path : "(null)");
+            return false;
+        }
+        return Parse(file.Data(), file.Size(), a_Document);
+    }
+
+    /** 
+     * \brief   Parses a document straight from the source, reporting to a handler.
+     */
+    bool Parser::Parse(const char * a_Data, size_t a_Size, ParseHandler & a_Handler)
+    {
+        m_ErrorString = "";
+        flow::Tokenizer tokenizer(a_Data, a_Data + a_Size, m_SymbolTable);
+        return ParseDocument(tokenizer, a_Handler);
+    }
+
+    bool Parser::ParseFile(const char * a_Path, ParseHandler & a_Handler)
+    {
+        flow::MappedFile file;
+        if (!file.Open(a_Path)) {
+            m_ErrorString = std::string("FAILED TO OPEN ") + (a_Path ? a_Path : "(null)");
+            return false;
+        }
+        return Parse(file.Data(), file.Size(), a_Handler);
+    }
+
+    static bool SameEvents(const FlowEventList & a_Left, const FlowEventList & a_Right)
+    {
+        if (a_Left.size() != a_Right.size()) {
+            return false;
+        }
+        for(size_t i = 0; i < a_Left.size(); ++i) {
+            if ((a_Left[i].NameIndex != a_Right[i].NameIndex) || (a_Left[i].Direction != a_Right[i].Direction)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool SameVariables(const FlowVariableList & a_Left, const FlowVariableList & a_Right)
+    {
+        if (a_Left.size() != a_Right.size()) {
+            return false;
+        }
+        for(size_t i = 0; i < a_Left.size(); ++i) {
+            const FlowVariable & left = a_Left[i], & right = a_Right[i];
+            if ((left.NameIndex != right.NameIndex) || (left.Type != right.Type) || 
+                (left.HasDirection != right.HasDirection) || (left.HasDefaultValue != right.HasDefaultValue)) {
+                return false;
+            }
+            if (left.HasDirection && (left.Direction != right.Direction)) {
+                return false;
+            }
+            if (left.HasDefaultValue) {
+                if ((left.Type == FlowVariable::TYPE_FLOAT) ? (left.DefaultValue.fValue != right.DefaultValue.fValue) : 
+                                                              (left.DefaultValue.bValue != right.DefaultValue.bValue)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Updates a document after its source was edited.
+     */
+    bool Parser::Reparse(const char * a_Data, size_t a_Size, const TextEdit & a_Edit, FlowDocument & a_Document, 
+        std::vector<DefinitionChange> & a_Changes)
+    {
+        m_ErrorString = "";
+        a_Changes.clear();
+        std::vector<FlowSpan> & spans = a_Document.Spans;
+        if (spans.size() != a_Document.Nodes.size() + a_Document.Queries.size()) {
+            m_ErrorString = "DOCUMENT HAS NO SOURCE SPANS";
+            return false;
+        }
+        if ((a_Edit.Begin > a_Edit.OldEnd) || (a_Edit.Begin > a_Edit.NewEnd) || (a_Edit.NewEnd > a_Size) ||
+            (!spans.empty() && (spans.back().End > a_Edit.OldEnd) && (spans.back().End - a_Edit.OldEnd + a_Edit.NewEnd > a_Size))) {
+            m_ErrorString = "INVALID EDIT";
+            return false;
+        }
+
+        /** the definitions from first on may be touched by the edit, those before it are kept as they are */
+        size_t first = 0;
+        while((first < spans.size()) && (spans[first].End <= a_Edit.Begin)) {
+            ++first;
+        }
+        /** the definitions from reusable on are past the edit and can be kept if the parse realigns with one */
+        size_t reusable = first;
+        while((reusable < spans.size()) && (spans[reusable].Begin < a_Edit.OldEnd)) {
+            ++reusable;
+        }
+
+        /** the parsed definitions spill into scratch memory, so a failed parse leaves nothing behind in the document */
+        m_Scratch.Reset();
+        std::vector<FlowNode>   nodes;
+        std::vector<FlowQuery>  queries;
+        std::vector<FlowSpan>   parsed;
+        flow::Tokenizer tokenizer(a_Data, a_Data + a_Size, m_SymbolTable);
+        tokenizer.Seek((first > 0) ? spans[first - 1].End : 0);
+
+        size_t last = spans.size();     /**< The first definition that is kept after the parsed ones */
+        Symbol_t sym = tokenizer.Peek();
+        while(sym != flow::T_EOF) {
+            size_t begin = tokenizer.TokenOffset();
+            while((reusable < spans.size()) && (spans[reusable].Begin - a_Edit.OldEnd + a_Edit.NewEnd < begin)) {
+                ++reusable;
+            }
+            if ((reusable < spans.size()) && (spans[reusable].Begin - a_Edit.OldEnd + a_Edit.NewEnd == begin)) {
+                last = reusable;
+                break;
+            }
+            if (sym == flow::T_KEYWORD_NODE) {
+                ReserveDefinitions(nodes, nodes.size() + 1);
+                DocumentDefinition<FlowNode> node(nodes.emplace_back(), m_Scratch);
+                if (!ParseNode(tokenizer, node)) {
+                    return false;
+                }
+                parsed.push_back(FlowSpan{begin, tokenizer.Offset(), static_cast<uint32_t>(nodes.size() - 1), false});
+            } else if (sym == flow::T_KEYWORD_QUERY) {
+                ReserveDefinitions(queries, queries.size() + 1);
+                DocumentDefinition<FlowQuery> query(queries.emplace_back(), m_Scratch);
+                if (!ParseQuery(tokenizer, query)) {
+                    return false;
+                }
+                parsed.push_back(FlowSpan{begin, tokenizer.Offset(), static_cast<uint32_t>(queries.size() - 1), true});
+            } else {
+                Unexpected(sym, tokenizer.Position());
+                return false;
+            }
+            sym = tokenizer.Peek();
+        }
+
+        /** the replaced definitions are a contiguous range of the nodes and of the queries */
+        size_t firstNode = 0, firstQuery = 0, oldNodes = 0, oldQueries = 0;
+        for(size_t i = 0; i < first; ++i) {
+            ++(spans[i].IsQuery ? firstQuery : firstNode);
+        }
+        for(size_t i = first; i < last; ++i) {
+            ++(spans[i].IsQuery ? oldQueries : oldNodes);
+        }
+
+        /** a definition is matched by kind and name, the first unmatched one with the same name wins */
+        struct Candidates {
+            std::vector<size_t>     Spans;      /**< Replaced definitions with the name, in source order */
+            size_t                  Next;       /**< The first of them that isn't matched */
+        };
+        std::unordered_map<uint64_t, Candidates> replaced;
+        for(size_t i = first; i < last; ++i) {
+            const FlowSpan & span = spans[i];
+            SymbolTable::SymIndex name = span.IsQuery ? a_Document.Queries[span.Index].NameIndex : a_Document.Nodes[span.Index].NameIndex;
+            replaced[(static_cast<uint64_t>(span.IsQuery) << 32) | name].Spans.push_back(i);
+        }
+        std::vector<bool> matched(last - first, false);
+        for(const FlowSpan & span : parsed) {
+            DefinitionChange change;
+            change.IsQuery  = span.IsQuery;
+            change.Index    = static_cast<uint32_t>(span.Index + (span.IsQuery ? firstQuery : firstNode));
+            change.NameIndex = span.IsQuery ? queries[span.Index].NameIndex : nodes[span.Index].NameIndex;
+            auto it = replaced.find((static_cast<uint64_t>(span.IsQuery) << 32) | change.NameIndex);
+            if ((it == replaced.end()) || (it->second.Next == it->second.Spans.size())) {
+                change.Type = DefinitionChange::DEFINITION_ADDED;
+                a_Changes.push_back(change);
+                continue;
+            }
+            size_t match = it->second.Spans[it->second.Next++];
+            matched[match - first] = true;
+            const FlowSpan & old = spans[match];
+            bool same = span.IsQuery ? 
+                (SameEvents(queries[span.Index].Events, a_Document.Queries[old.Index].Events) && 
+                 SameVariables(queries[span.Index].Variables, a_Document.Queries[old.Index].Variables)) :
+                (SameEvents(nodes[span.Index].Events, a_Document.Nodes[old.Index].Events) && 
+                 SameVariables(nodes[span.Index].Variables, a_Document.Nodes[old.Index].Variables));
+            if (!same) {
+                change.Type = DefinitionChange::DEFINITION_MODIFIED;
+                a_Changes.push_back(change);
+            }
+        }
+        for(size_t i = first; i < last; ++i) {
+            if (!matched[i - first]) {
+                DefinitionChange change;
+                change.Type         = DefinitionChange::DEFINITION_REMOVED;
+                change.IsQuery      = spans[i].IsQuery;
+                change.NameIndex    = spans[i].IsQuery ? a_Document.Queries[spans[i].Index].NameIndex : a_Document.Nodes[spans[i].Index].NameIndex;
+                change.Index        = 0;
+                a_Changes.push_back(change);
+            }
+        }
+
+        /** the replaced definitions leave their storage behind, the parsed ones move into it */
+        for(size_t i = first; i < last; ++i) {
+            a_Document.ReleasedStorage += spans[i].IsQuery ? 
+                (SpilledBytes(a_Document.Queries[spans[i].Index].Events) + SpilledBytes(a_Document.Queries[spans[i].Index].Variables)) :
+                (SpilledBytes(a_Document.Nodes[spans[i].Index].Events) + SpilledBytes(a_Document.Nodes[spans[i].Index].Variables));
+        }
+        RelocateDefinitions(nodes, a_Document.Storage);
+        RelocateDefinitions(queries, a_Document.Storage);
+
+        /** splice the parsed definitions in and shift the ones after them */
+        size_t parsedNodes = nodes.size(), parsedQueries = queries.size();
+        SpliceDefinitions(a_Document.Nodes, firstNode, oldNodes, nodes);
+        SpliceDefinitions(a_Document.Queries, firstQuery, oldQueries, queries);
+
+        for(FlowSpan & span : parsed) {
+            span.Index += static_cast<uint32_t>(span.IsQuery ? firstQuery : firstNode);
+        }
+        for(size_t i = last; i < spans.size(); ++i) {
+            FlowSpan & span = spans[i];
+            span.Begin  = span.Begin - a_Edit.OldEnd + a_Edit.NewEnd;
+            span.End    = span.End - a_Edit.OldEnd + a_Edit.NewEnd;
+            span.Index  = static_cast<uint32_t>(span.Index - (span.IsQuery ? oldQueries : oldNodes) + (span.IsQuery ? parsedQueries : parsedNodes));
+        }
+        spans.erase(spans.begin() + first, spans.begin() + last);
+        spans.insert(spans.begin() + first, parsed.begin(), parsed.end());
+
+        /** once half the storage is dead the live members are copied to new storage */
+        if (a_Document.ReleasedStorage * 2 > a_Document.Storage.Capacity()) {
+            Arena storage;
+            RelocateDefinitions(a_Document.Nodes, storage);
+            RelocateDefinitions(a_Document.Queries, storage);
+            a_Document.Storage          = std::move(storage);
+            a_Document.ReleasedStorage  = 0;
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Runs only the lexing pass, interning names in this parser's symbol table.
+     */
+    bool Parser::Lex(const char * a_Data, size_t a_Size, TokenBuffer & a_Tokens)
+    {
+        m_ErrorString = "";
+        flow::Tokenizer tokenizer(a_Data, a_Data + a_Size, m_SymbolTable);
+        if (!tokenizer.Lex(a_Tokens)) {
+            m_ErrorString = "DOCUMENT TOO LARGE";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Parses a document that was lexed by this parser.
+     */
+    bool Parser::Parse(const TokenBuffer & a_Tokens, FlowDocument & a_Document)
+    {
+        return ParseTokens(a_Tokens, a_Document, nullptr);
+    }
+
+    bool Parser::ParseTokens(const TokenBuffer & a_Tokens, FlowDocument & a_Document, DocumentIndex * a_pIndex)
+    {
+        m_ErrorString = "";
+        if (a_Tokens.Size() == 0) {
+            m_ErrorString = "EMPTY TOKEN BUFFER";
+            return false;
+        }
+        /** documents parsed by one parser tend to be alike, so start at the size of the last one */
+        ReserveDefinitions(a_Document.Nodes, a_Document.Nodes.size() + m_nNodeHint);
+        ReserveDefinitions(a_Document.Queries, a_Document.Queries.size() + m_nQueryHint);
+        size_t nodes = a_Document.Nodes.size(), queries = a_Document.Queries.size();
+
+        flow::TokenStream stream(a_Tokens, m_SymbolTable);
+        bool success = ParseDocument(stream, a_Document, a_pIndex);
+        m_nNodeHint     = a_Document.Nodes.size() - nodes;
+        m_nQueryHint    = a_Document.Queries.size() - queries;
+        return success;
+    }
+
+    bool Parser::Parse(const TokenBuffer & a_Tokens, FlatDocument & a_Document)
+    {
+        m_ErrorString = "";
+        if (a_Tokens.Size() == 0) {
+            m_ErrorString = "EMPTY TOKEN BUFFER";
+            return false;
+        }
+        ReserveAppend(a_Document.Nodes, a_Document.Nodes.size() + m_nNodeHint);
+        ReserveAppend(a_Document.Queries, a_Document.Queries.size() + m_nQueryHint);
+        ReserveAppend(a_Document.Events, a_Document.Events.size() + m_nEventHint);
+        ReserveAppend(a_Document.Variables, a_Document.Variables.size() + m_nVariableHint);
+        size_t nodes = a_Document.Nodes.size(), queries = a_Document.Queries.size();
+        size_t events = a_Document.Events.size(), variables = a_Document.Variables.size();
+
+        flow::TokenStream stream(a_Tokens, m_SymbolTable);
+        bool success = ParseDocument(stream, a_Document);
+        m_nNodeHint     = a_Document.Nodes.size() - nodes;
+        m_nQueryHint    = a_Document.Queries.size() - queries;
+        m_nEventHint    = a_Document.Events.size() - events;
+        m_nVariableHint = a_Document.Variables.size() - variables;
+        return success;
+    }
+
+    /** 
+     * \brief   Memory maps a file read-only and parses the flow definitions in it.
+     *
+     * The tokenizer runs directly over the mapping, so the file contents are never
+     * copied onto the heap.
+     */
+    bool Parser::ParseFile(const char * a_Path, FlowDocument & a_Document)
+    {
+        flow::MappedFile file;
+        if (!file.Open(a_Path)) {
+            m_ErrorString = std::string("FAILED TO OPEN ") + (a_Path ? a_Path : "(null)");
+            return false;
+        }
+        return Parse(file.Data(), file.Size(), a_Document);
+    }
+
+    /**
+     * \brief   Internal implementation of the parsing that uses a tokenizer.
+     */
+    bool Parser::ParseDocument(flow::TokenStream & a_Tokenizer, FlowDocument & a_Document, DocumentIndex * a_pIndex)
+    {
+        Symbol_t sym = a_Tokenizer.Peek();
+        while( sym != flow::T_EOF ) 
+        {
+            /** definitions are parsed in place, a definition that fails is not part of the document */
+            size_t begin = a_Tokenizer.NextOffset();
+            if (sym == flow::T_KEYWORD_NODE) {
+                size_t position = a_Document.Nodes.size();
+                ReserveDefinitions(a_Document.Nodes, position + 1);
+                DocumentDefinition<FlowNode> node(a_Document.Nodes.emplace_back(), a_Document.Storage, a_pIndex, position);
+                if (!ParseNode(a_Tokenizer, node)) {
+                    a_Document.Nodes.pop_back();
+                    return false;
+                }
+                a_Document.Spans.push_back(FlowSpan{begin, a_Tokenizer.TokenOffset() + 1, static_cast<uint32_t>(a_Document.Nodes.size() - 1), false});
+            } else if (sym == flow::T_KEYWORD_QUERY) {
+                size_t position = a_Document.Queries.size();
+                ReserveDefinitions(a_Document.Queries, position + 1);
+                DocumentDefinition<FlowQuery> query(a_Document.Queries.emplace_back(), a_Document.Storage, a_pIndex, position);
+                if (!ParseQuery(a_Tokenizer, query)) {
+                    a_Document.Queries.pop_back();
+                    return false;
+                }
+                a_Document.Spans.push_back(FlowSpan{begin, a_Tokenizer.TokenOffset() + 1, static_cast<uint32_t>(a_Document.Queries.size() - 1), true});
+            } else {
+                Unexpected(sym, a_Tokenizer.Position());
+                return false;
+            }
+            sym = a_Tokenizer.Peek();
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Appends the definitions of a document to the flat arrays of a FlatDocument,
+     *          standing in for a FlowNode or FlowQuery while one is parsed.
+     */
+    struct FlatDefinitionBuilder
+    {
+        FlatDefinitionBuilder(FlatDocument & a_Document) : Document(a_Document)
+        {
+            Definition.Name             = 0;
+            Definition.FirstEvent       = static_cast<uint32_t>(a_Document.Events.size());
+            Definition.EventCount       = 0;
+            Definition.FirstVariable    = static_cast<uint32_t>(a_Document.Variables.size());
+            Definition.VariableCount    = 0;
+        }
+
+        bool SetName(SymbolTable::SymIndex a_Name)
+        {
+            Definition.Name = a_Name;
+            return true;
+        }
+
+        bool AddEvent(const FlowEvent & a_Event)
+        {
+            Document.Events.push_back(MakeFlatEvent(a_Event));
+            ++Definition.EventCount;
+            return true;
+        }
+
+        bool AddVariable(const FlowVariable & a_Variable)
+        {
+            Document.Variables.push_back(MakeFlatVariable(a_Variable));
+            ++Definition.VariableCount;
+            return true;
+        }
+
+        FlatDocument &  Document;
+        FlatDefinition  Definition;
+    };
+
+    /**
+     * \brief   Reports a definition to a ParseHandler, standing in for a FlowNode or FlowQuery 
+     *          while one is parsed.
+     */
+    struct HandlerDefinition
+    {
+        HandlerDefinition(ParseHandler & a_Handler, bool a_IsNode) : Handler(a_Handler), IsNode(a_IsNode), Stopped(false), Name(0)
+        {
+        }
+
+        /** Passes on what a handler returned, remembering if it stopped the parse */
+        bool Continue(bool a_Continue)
+        {
+            Stopped = !a_Continue;
+            return a_Continue;
+        }
+
+        bool SetName(SymbolTable::SymIndex a_Name)
+        {
+            Name = a_Name;
+            return Continue(IsNode ? Handler.OnNodeBegin(a_Name) : Handler.OnQueryBegin(a_Name));
+        }
+
+        bool AddEvent(const FlowEvent & a_Event)            {return Continue(Handler.OnEvent(a_Event));}
+        bool AddVariable(const FlowVariable & a_Variable)   {return Continue(Handler.OnVariable(a_Variable));}
+
+        ParseHandler &          Handler;
+        bool                    IsNode;
+        bool                    Stopped;    /**< The handler returned false */
+        SymbolTable::SymIndex   Name;
+    };
+
+    /**
+     * \brief   Internal implementation of the parsing that reports to a handler.
+     */
+    bool Parser::ParseDocument(flow::Tokenizer & a_Tokenizer, ParseHandler & a_Handler)
+    {
+        Symbol_t sym = a_Tokenizer.Peek();
+        while( sym != flow::T_EOF ) 
+        {
+            if ((sym == flow::T_KEYWORD_NODE) || (sym == flow::T_KEYWORD_QUERY)) {
+                HandlerDefinition definition(a_Handler, sym == flow::T_KEYWORD_NODE);
+                bool success = definition.IsNode ? ParseNode(a_Tokenizer, definition) : ParseQuery(a_Tokenizer, definition);
+                if (success) {
+                    success = definition.Continue(definition.IsNode ? a_Handler.OnNodeEnd(definition.Name) : a_Handler.OnQueryEnd(definition.Name));
+                }
+                if (!success) {
+                    if (definition.Stopped) {
+                        m_ErrorString = "STOPPED BY HANDLER";
+                    }
+                    return false;
+                }
+            } else {
+                Unexpected(sym, a_Tokenizer.Position());
+                return false;
+            }
+            sym = a_Tokenizer.Peek();
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Internal implementation of the parsing into a flat document.
+     */
+    bool Parser::ParseDocument(flow::TokenStream & a_Tokenizer, FlatDocument & a_Document)
+    {
+        Symbol_t sym = a_Tokenizer.Peek();
+        while( sym != flow::T_EOF ) 
+        {
+            if (sym == flow::T_KEYWORD_NODE) {
+                FlatDefinitionBuilder node(a_Document);
+                if (!ParseNode(a_Tokenizer, node)) {
+                    return false;
+                }
+                a_Document.Nodes.push_back(node.Definition);
+            } else if (sym == flow::T_KEYWORD_QUERY) {
+                FlatDefinitionBuilder query(a_Document);
+                if (!ParseQuery(a_Tokenizer, query)) {
+                    return false;
+                }
+                a_Document.Queries.push_back(query.Definition);
+            } else {
+                Unexpected(sym, a_Tokenizer.Position());
+                return false;
+            }
+            sym = a_Tokenizer.Peek();
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Parses a flow node definition, the grammar is shared with the StaticParser.
+     */
+    template<class Tokens, class Definition>
+    bool Parser::ParseNode(Tokens & a_Tokenizer, Definition & a_Node)
+    {
+        Grammar<Tokens> grammar(a_Tokenizer);
+        if (!grammar.ParseNode(a_Node)) {
+            return Failed(grammar, a_Tokenizer);
+        }
+        return true;
+    }
+
+    template<class Tokens, class Definition>
+    bool Parser::ParseQuery(Tokens & a_Tokenizer, Definition & a_Query)
+    {
+        Grammar<Tokens> grammar(a_Tokenizer);
+        if (!grammar.ParseQuery(a_Query)) {
+            return Failed(grammar, a_Tokenizer);
+        }
+        return true;
+    }
+
+    /**
+     * \brief   Describes the error the grammar stopped at, if it didn't stop for the builder.
+     */
+    template<class Tokens>
+    bool Parser::Failed(const Grammar<Tokens> & a_Grammar, Tokens & a_Tokenizer)
+    {
+        if (a_Grammar.Status == GRAMMAR_EXPECTED) {
+            Expected(a_Grammar.Expected, a_Grammar.Actual, a_Tokenizer.Position());
+        } else if (a_Grammar.Status == GRAMMAR_UNEXPECTED) {
+            Unexpected(a_Grammar.Actual, a_Tokenizer.Position());
+        }
+        return false;
+    }
+
+    std::ostream & operator << (std::ostream & os, const PositionInfo & pos) 
+    {
+        os << "(Ln: " << pos.Row << ", Col: " << pos.Col << ")";
+        return os;
+    }
+
+    void Parser::Expected(Symbol_t a_Expected, Symbol_t a_Actual, const flow::PositionInfo & a_Position)
+    {
+        PositionInfo position = a_Position;
+        if (position.Row == 0) {
+            position.Col += m_nColumnOffset;
+        }
+        position.Row += m_nRowOffset;
+        std::stringstream err;
+        err << "EXPECTED " << flow::Tokenizer::GetTokenString(a_Expected) << " at " << position 
+            << ", actual " <<  flow::Tokenizer::GetTokenString(a_Actual);
+        m_ErrorString = err.str();
+    }
+
+    void Parser::Unexpected(Symbol_t a_Sym, const flow::PositionInfo & a_Position)
+    {
+        PositionInfo position = a_Position;
+        if (position.Row == 0) {
+            position.Col += m_nColumnOffset;
+        }
+        position.Row += m_nRowOffset;
+        std::stringstream err;
+        err << "UNEXPECTED " << flow::Tokenizer::GetTokenString(a_Sym) << " at " << position;
+        m_ErrorString = err.str();
+    }
+
+    void Parser::Reset()
+    {
+        /** one unusually large document shouldn't pin its memory for the life of the parser */
+        bool keep = (m_SymbolTable.MemoryUsage() + m_Tokens.MemoryUsage() + m_Scratch.Capacity()) <= MaxRetainedMemory;
+        m_SymbolTable.Clear(keep);
+        if (keep) {
+            m_Tokens.Clear();
+        } else {
+            m_Tokens        = flow::TokenBuffer();
+            m_Scratch.Release();
+            m_nNodeHint     = 0;
+            m_nQueryHint    = 0;
+            m_nEventHint    = 0;
+            m_nVariableHint = 0;
+        }
+        m_ErrorString.clear();
+    }
+
+    const std::string & Parser::GetErrorString() const 
+    {
+        return m_ErrorString;
+    }
+
+    const char * Parser::GetString(SymbolTable::SymIndex a_Index) const
+    {
+        return m_SymbolTable.Retrive(a_Index);
+    }
 }
\ No newline at end of file
@@ -1,109 +1,476 @@
-#ifndef _FLOW_PARSER_H_
-#define _FLOW_PARSER_H_
-
-#include <list>
-#include <vector>
-
-#include "pool.h"
-#include "token.h"
-
-namespace flow
-{
-    struct FlowEvent
-    {
-        typedef enum {
-            EVENT_IN,       /**< Input event */
-            EVENT_OUT       /**< Ouput event */
-        } EventDirection;
-
-        EventDirection  Direction;
-        size_t          NameIndex;  /**< Index into the parsers string pool */
-    };
-
-    struct FlowVariable
-    {
-        enum {
-            TYPE_BOOL,      /**< boolean */
-            TYPE_FLOAT,     /**< float */
-        } Type;
-
-        /** Only valid if HasDefaultValue is true */
-        union {
-            float   fValue;
-            bool    bValue;
-        } DefaultValue;
-
-        unsigned char HasDefaultValue   : 1;    /**< Indicates if the variable has a default value */
-        unsigned char HasDirection      : 1;    /**< Indicates if the variable has a direction prefix */
-
-        FlowEvent::EventDirection   Direction;  /**< Only valid if HasDirection is true */      
-        size_t                      NameIndex;  /**< Index into the parsers string pool */
-    };
-
-    /**
-     * \brief A flow node.
-     */
-    struct FlowNode 
-    {
-        size_t                      NameIndex;  /**< Index into the parsers string pool */
-        std::vector<FlowEvent>      Events;
-        std::vector<FlowVariable>   Variables;
-    };
-
-    /**
-     * \brief A flow query.
-     */
-    struct FlowQuery 
-    {
-        size_t                      NameIndex;  /**< Index into the parsers string pool */
-        std::vector<FlowVariable>   Variables;
-        std::vector<FlowEvent>      Events;
-    };
-
-    struct FlowDocument
-    {
-        std::vector< FlowNode >     Nodes;      /**< Nodes defined in the document */
-        std::vector< FlowQuery >    Queries;    /**< Queries defined in the document */     
-    };
-
-    /**
-     * \brief   Parses a document with flow definitions.
-     */
-    class Parser
-    {
-    public:
-        /** 
-         * \brief   Parses a document containing flow definitions.
-         * \param   a_String    The document as a string.
-         * \param   a_Document  The document as a string.
-         *
-         * \return  true if the document was parsed successfully, or false otherwise.
-         */
-        bool Parse(const std::string & a_String, FlowDocument & a_Document);
-        /**
-         * \brief   Returns a string that describes the last error encountered.
-         */
-        const std::string & GetErrorString() const;
-        /**
-         * \brief   Returns the string a the specified position.
-         */
-        const char * GetString(size_t) const;
-
-    protected:
-
-        bool ParseDocument(flow::Tokenizer & a_Tokenizer, FlowDocument & a_Document);
-        bool ParseNode(flow::Tokenizer & a_Tokenizer, FlowNode & a_Node);
-        bool ParseVariable(flow::Tokenizer & a_Tokenizer, FlowVariable & a_Variable);
-        bool ParseEvent(flow::Tokenizer & a_Tokenizer, FlowEvent & a_Event);
-        bool ParseQuery(flow::Tokenizer & a_Tokenizer, FlowQuery & a_Query);
-
-        bool Expect(Symbol_t, flow::Tokenizer & tokenizer);
-        void Unexpected(Symbol_t, const PositionInfo &);
-        bool InsertName(const char *, size_t *);
-
-        flow::Pool<char, 64>    m_StringPool;
-        std::string             m_ErrorString;
-    };
-}
-
+#ifndef _FLOW_PARSER_H_
+#define _FLOW_PARSER_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "pool.h"
+#include "small_vector.h"
+#include "token.h"
+#include "token_buffer.h"
+
+namespace flow
+{
+    struct FlowEvent
+    {
+        typedef enum {
+            EVENT_IN,       /**< Input event */
+            EVENT_OUT       /**< Ouput event */
+        } EventDirection;
+
+        EventDirection          Direction;
+        SymbolTable::SymIndex   NameIndex;  /**< Symbol in the parsers symbol table */
+    };
+
+    struct FlowVariable
+    {
+        enum {
+            TYPE_BOOL,      /**< boolean */
+            TYPE_FLOAT,     /**< float */
+        } Type;
+
+        /** Only valid if HasDefaultValue is true */
+        union {
+            float   fValue;
+            bool    bValue;
+        } DefaultValue;
+
+        unsigned char HasDefaultValue   : 1;    /**< Indicates if the variable has a default value */
+        unsigned char HasDirection      : 1;    /**< Indicates if the variable has a direction prefix */
+
+        FlowEvent::EventDirection   Direction;  /**< Only valid if HasDirection is true */      
+        SymbolTable::SymIndex       NameIndex;  /**< Symbol in the parsers symbol table */
+    };
+
+    /** Most definitions have a handful of events and variables, those never touch the heap */
+    typedef SmallVector<FlowEvent, 4>       FlowEventList;
+    typedef SmallVector<FlowVariable, 4>    FlowVariableList;
+
+    /**
+     * \brief A flow node.
+     */
+    struct FlowNode 
+    {
+        SymbolTable::SymIndex       NameIndex;  /**< Symbol in the parsers symbol table */
+        FlowEventList               Events;
+        FlowVariableList            Variables;
+    };
+
+    /**
+     * \brief A flow query.
+     */
+    struct FlowQuery 
+    {
+        SymbolTable::SymIndex       NameIndex;  /**< Symbol in the parsers symbol table */
+        FlowVariableList            Variables;
+        FlowEventList               Events;
+    };
+
+    /**
+     * \brief   Where a definition is in the source.
+     */
+    struct FlowSpan
+    {
+        size_t      Begin;      /**< Offset of the node or query keyword */
+        size_t      End;        /**< Offset after the closing bracket */
+        uint32_t    Index;      /**< Index in Nodes or Queries */
+        bool        IsQuery;
+    };
+
+    /**
+     * \brief   The definitions of a parsed document.
+     *
+     * Events and variables that don't fit inline in their definition are allocated from the
+     * document's Storage, so a document that is cleared and parsed into again reuses the same
+     * memory. A copy of a document keeps them on the heap instead. Storage left behind by the
+     * definitions a Parser::Reparse() replaced is reclaimed once it is half of the storage.
+     */
+    struct FlowDocument
+    {
+        FlowDocument() : ReleasedStorage(0)
+        {
+        }
+
+        FlowDocument(const FlowDocument & a_Other) : Nodes(a_Other.Nodes), Queries(a_Other.Queries), Spans(a_Other.Spans), ReleasedStorage(0)
+        {
+        }
+
+        FlowDocument(FlowDocument && a_Other) = default;
+
+        FlowDocument & operator=(const FlowDocument & a_Other)
+        {
+            Nodes   = a_Other.Nodes;
+            Queries = a_Other.Queries;
+            Spans   = a_Other.Spans;
+            return *this;
+        }
+
+        /** The definitions are replaced before the storage they may refer to is released */
+        FlowDocument & operator=(FlowDocument && a_Other) noexcept
+        {
+            Nodes   = std::move(a_Other.Nodes);
+            Queries = std::move(a_Other.Queries);
+            Spans   = std::move(a_Other.Spans);
+            Storage = std::move(a_Other.Storage);
+            ReleasedStorage = a_Other.ReleasedStorage;
+            return *this;
+        }
+
+        /** Empties the document, keeping the memory for the next parse */
+        void Clear()
+        {
+            Nodes.clear();
+            Queries.clear();
+            Spans.clear();
+            Storage.Reset();
+            ReleasedStorage = 0;
+        }
+
+        Arena                       Storage;    /**< Spilled events and variables, outlives the definitions */
+        std::vector< FlowNode >     Nodes;      /**< Nodes defined in the document */
+        std::vector< FlowQuery >    Queries;    /**< Queries defined in the document */     
+        std::vector< FlowSpan >     Spans;      /**< Every definition in source order, used by Parser::Reparse() */
+        size_t                      ReleasedStorage;    /**< Bytes of Storage no definition uses any more */
+    };
+
+    /**
+     * \brief   An edit of a source, the bytes [Begin, OldEnd) were replaced with the bytes [Begin, NewEnd).
+     */
+    struct TextEdit
+    {
+        size_t      Begin;
+        size_t      OldEnd;
+        size_t      NewEnd;
+    };
+
+    /**
+     * \brief   A definition that was added, removed or modified by Parser::Reparse().
+     */
+    struct DefinitionChange
+    {
+        typedef enum {
+            DEFINITION_ADDED,
+            DEFINITION_REMOVED,
+            DEFINITION_MODIFIED
+        } ChangeType;
+
+        ChangeType              Type;
+        bool                    IsQuery;
+        SymbolTable::SymIndex   NameIndex;  /**< Symbol in the parsers symbol table */
+        uint32_t                Index;      /**< Index in Nodes or Queries of the updated document, unless removed */
+    };
+
+    /**
+     * \brief   An event in a FlatDocument.
+     */
+    struct FlatEvent
+    {
+        uint32_t    Name;               /**< Symbol in the parsers symbol table */
+        uint8_t     Direction;          /**< FlowEvent::EventDirection */
+        uint8_t     Padding[3];
+    };
+
+    /**
+     * \brief   A variable in a FlatDocument.
+     */
+    struct FlatVariable
+    {
+        enum {
+            HAS_DEFAULT_VALUE   = 1 << 0,
+            HAS_DIRECTION       = 1 << 1
+        };
+
+        uint32_t    Name;               /**< Symbol in the parsers symbol table */
+        uint8_t     Type;               /**< FlowVariable::TYPE_BOOL or TYPE_FLOAT */
+        uint8_t     Flags;
+        uint8_t     Direction;          /**< Only valid with HAS_DIRECTION */
+        uint8_t     Padding;
+        union {
+            float       fValue;
+            uint32_t    bValue;
+        } DefaultValue;                 /**< Only valid with HAS_DEFAULT_VALUE */
+    };
+
+    /**
+     * \brief   A node or query in a FlatDocument, owning a range of the document's events and variables.
+     */
+    struct FlatDefinition
+    {
+        uint32_t    Name;               /**< Symbol in the parsers symbol table */
+        uint32_t    FirstEvent;
+        uint32_t    EventCount;
+        uint32_t    FirstVariable;
+        uint32_t    VariableCount;
+    };
+
+    static_assert(sizeof(FlatEvent) == 8, "FlatEvent must not contain padding");
+    static_assert(sizeof(FlatVariable) == 12, "FlatVariable must not contain padding");
+    static_assert(sizeof(FlatDefinition) == 20, "FlatDefinition must not contain padding");
+
+    /** Converts an event or variable as the parser reports it to the flat layout */
+    constexpr FlatEvent MakeFlatEvent(const FlowEvent & a_Event)
+    {
+        FlatEvent ev = {};
+        ev.Name         = a_Event.NameIndex;
+        ev.Direction    = static_cast<uint8_t>(a_Event.Direction);
+        return ev;
+    }
+
+    constexpr FlatVariable MakeFlatVariable(const FlowVariable & a_Variable)
+    {
+        FlatVariable var = {};
+        var.Name = a_Variable.NameIndex;
+        var.Type = static_cast<uint8_t>(a_Variable.Type);
+        if (a_Variable.HasDirection) {
+            var.Flags       |= FlatVariable::HAS_DIRECTION;
+            var.Direction   = static_cast<uint8_t>(a_Variable.Direction);
+        }
+        if (a_Variable.HasDefaultValue) {
+            var.Flags |= FlatVariable::HAS_DEFAULT_VALUE;
+            if (a_Variable.Type == FlowVariable::TYPE_FLOAT) {
+                var.DefaultValue.fValue = a_Variable.DefaultValue.fValue;
+            } else {
+                var.DefaultValue.bValue = a_Variable.DefaultValue.bValue ? 1 : 0;
+            }
+        }
+        return var;
+    }
+
+    /**
+     * \brief   A document stored as a few flat arrays instead of a tree of vectors.
+     *
+     * The events and variables of all definitions share one array each, in document order, 
+     * so parsing allocates only when an array grows and a sweep over every event of every
+     * node is a linear walk through memory.
+     */
+    struct FlatDocument
+    {
+        std::vector< FlatDefinition >   Nodes;      /**< Nodes defined in the document */
+        std::vector< FlatDefinition >   Queries;    /**< Queries defined in the document */
+        std::vector< FlatEvent >        Events;     /**< Events of all definitions */
+        std::vector< FlatVariable >     Variables;  /**< Variables of all definitions */
+
+        /** Empties the document, keeping the memory for the next parse */
+        void Clear()
+        {
+            Nodes.clear();
+            Queries.clear();
+            Events.clear();
+            Variables.clear();
+        }
+    };
+
+    /**
+     * \brief   Rewrites every name in the document through a symbol index mapping, used
+     *          when moving a document from one symbol table to another.
+     */
+    void RemapNames(FlowDocument & a_Document, const std::vector<SymbolTable::SymIndex> & a_Map);
+
+    /**
+     * \brief   Receives the definitions of a document while it is parsed, instead of a
+     *          document being built.
+     *
+     * Names are symbols in the parser's symbol table. The events and variables of a 
+     * definition arrive between its begin and end callbacks, and returning false from any
+     * callback stops the parse with the error "STOPPED BY HANDLER".
+     */
+    class ParseHandler
+    {
+    public:
+        virtual ~ParseHandler() {}
+
+        virtual bool OnNodeBegin(SymbolTable::SymIndex /*a_Name*/)      {return true;}
+        virtual bool OnNodeEnd(SymbolTable::SymIndex /*a_Name*/)        {return true;}
+        virtual bool OnQueryBegin(SymbolTable::SymIndex /*a_Name*/)     {return true;}
+        virtual bool OnQueryEnd(SymbolTable::SymIndex /*a_Name*/)       {return true;}
+        virtual bool OnEvent(const FlowEvent & /*a_Event*/)             {return true;}
+        virtual bool OnVariable(const FlowVariable & /*a_Variable*/)    {return true;}
+    };
+
+    class DocumentIndex;
+    template<class Tokens> class Grammar;
+
+    /**
+     * \brief   Parses a document with flow definitions.
+     */
+    class Parser
+    {
+    public:
+        Parser();
+
+        /** 
+         * \brief   Parses a document containing flow definitions.
+         * \param   a_String    The document as a string.
+         * \param   a_Document  The document as a string.
+         *
+         * \return  true if the document was parsed successfully, or false otherwise.
+         */
+        bool Parse(const std::string & a_String, FlowDocument & a_Document);
+        /** 
+         * \brief   Parses a document held in a buffer, without copying it.
+         * \param   a_Data      The first character of the document.
+         * \param   a_Size      The length of the document in bytes.
+         * \param   a_Document  The document that receives the definitions.
+         *
+         * \return  true if the document was parsed successfully, or false otherwise.
+         */
+        bool Parse(const char * a_Data, size_t a_Size, FlowDocument & a_Document);
+        /** 
+         * \brief   Parses a document and indexes its definitions in the same pass, instead of
+         *          a DocumentIndex::Build() over the parsed document.
+         * \param   a_Index     Receives the names of every definition in the document.
+         *
+         * \return  true if the document was parsed successfully and its names are unique, or 
+         *          false otherwise. A duplicate name doesn't stop the parse, the index and the 
+         *          parser report it once the document is parsed.
+         */
+        bool Parse(const char * a_Data, size_t a_Size, FlowDocument & a_Document, DocumentIndex & a_Index);
+        /** 
+         * \brief   Memory maps a file read-only and parses the flow definitions in it.
+         * \param   a_Path      Path to the file.
+         * \param   a_Document  The document that receives the definitions.
+         *
+         * \return  true if the document was parsed successfully, or false otherwise.
+         */
+        bool ParseFile(const char * a_Path, FlowDocument & a_Document);
+        /** 
+         * \brief   Parses a document into the flat representation, the definitions are
+         *          appended to the document.
+         *
+         * \return  true if the document was parsed successfully, or false otherwise.
+         */
+        bool Parse(const char * a_Data, size_t a_Size, FlatDocument & a_Document);
+        bool ParseFile(const char * a_Path, FlatDocument & a_Document);
+        /** 
+         * \brief   Parses a document straight from the source, reporting the definitions to a
+         *          handler as they are recognized.
+         * \param   a_Data      The first character of the document.
+         * \param   a_Size      The length of the document in bytes.
+         * \param   a_Handler   Receives the definitions.
+         *
+         * Nothing is kept per definition and the source isn't lexed ahead, so apart from the 
+         * interned names the memory used doesn't depend on the size of the document.
+         *
+         * \return  true if the document was parsed successfully, or false if it failed to 
+         *          parse or the handler stopped the parse.
+         */
+        bool Parse(const char * a_Data, size_t a_Size, ParseHandler & a_Handler);
+        bool ParseFile(const char * a_Path, ParseHandler & a_Handler);
+        /** 
+         * \brief   Parses a large document on several threads.
+         * \param   a_Data      The first character of the document.
+         * \param   a_Size      The length of the document in bytes.
+         * \param   a_Document  The document that receives the definitions.
+         * \param   a_Threads   Number of worker threads, 0 uses one per hardware thread.
+         *
+         * The document is split at top-level node and query definitions, each part is lexed
+         * and parsed with a symbol table of its own and the parts are merged in document order. 
+         * The resulting document, name indices and error messages are identical to Parse().
+         *
+         * \return  true if the document was parsed successfully, or false otherwise.
+         */
+        bool ParseParallel(const char * a_Data, size_t a_Size, FlowDocument & a_Document, unsigned a_Threads = 0);
+        /**
+         * \brief   Updates a document after its source was edited, parsing only the definitions
+         *          the edit touched.
+         * \param   a_Data      The first character of the edited document.
+         * \param   a_Size      The length of the edited document in bytes.
+         * \param   a_Edit      The range that was replaced.
+         * \param   a_Document  A document this parser parsed from the source before the edit.
+         * \param   a_Changes   Receives the definitions that were added, removed or modified.
+         *
+         * Parsing starts after the last definition that ends before the edit, and stops at the
+         * first definition that starts after the edit and was already in the document. The 
+         * parsed definitions replace the ones they cover, the rest are kept with their spans
+         * shifted. Names are interned in the same symbol table as before.
+         *
+         * \return  true if the document was updated, or false if the edited source doesn't parse,
+         *          in which case the document is left unchanged.
+         */
+        bool Reparse(const char * a_Data, size_t a_Size, const TextEdit & a_Edit, FlowDocument & a_Document, 
+            std::vector<DefinitionChange> & a_Changes);
+        /**
+         * \brief   Runs only the lexing pass, interning names in this parser's symbol table.
+         * \param   a_Data      The first character of the document, must outlive the token buffer.
+         * \param   a_Size      The length of the document in bytes.
+         * \param   a_Tokens    Receives the symbols of the document.
+         *
+         * \return  true if the document was lexed successfully, or false otherwise.
+         */
+        bool Lex(const char * a_Data, size_t a_Size, TokenBuffer & a_Tokens);
+        /**
+         * \brief   Parses a document that was lexed by this parser, so the same document
+         *          can be parsed again without lexing it again.
+         *
+         * \return  true if the document was parsed successfully, or false otherwise.
+         */
+        bool Parse(const TokenBuffer & a_Tokens, FlowDocument & a_Document);
+        bool Parse(const TokenBuffer & a_Tokens, FlatDocument & a_Document);
+        /**
+         * \brief   Forgets every symbol so the parser can be reused for unrelated documents
+         *          without growing, the name indices of earlier documents become invalid.
+         *
+         * Memory is kept for the next document and the reset is O(1), unless the parser 
+         * holds more than MaxRetainedMemory in which case it is returned to the system.
+         */
+        void Reset();
+        /**
+         * \brief   Rows added to the positions in error messages, for when the parsed text is
+         *          a part of a larger source that starts at the beginning of a line.
+         */
+        void SetRowOffset(size_t a_Rows)                    {m_nRowOffset = a_Rows;}
+        /**
+         * \brief   Columns added to the positions on the first row in error messages, for when
+         *          the parsed text starts in the middle of a line of a larger source.
+         */
+        void SetColumnOffset(size_t a_Columns)              {m_nColumnOffset = a_Columns;}
+        /**
+         * \brief   Returns a string that describes the last error encountered.
+         */
+        const std::string & GetErrorString() const;
+        /**
+         * \brief   Returns the name of a symbol, names are interned so two NameIndex values
+         *          are equal exactly when the names are.
+         */
+        const char * GetString(SymbolTable::SymIndex) const;
+        /**
+         * \brief   The symbol table shared by the tokenizer and every document parsed by this parser.
+         */
+        const flow::SymbolTable & GetSymbolTable() const    {return m_SymbolTable;}
+
+        /** Memory a parser keeps across Reset() calls */
+        static const size_t MaxRetainedMemory = 64 * 1024 * 1024;
+
+    protected:
+
+        bool ParseTokens(const TokenBuffer & a_Tokens, FlowDocument & a_Document, DocumentIndex * a_pIndex);
+        bool ParseDocument(flow::TokenStream & a_Tokenizer, FlowDocument & a_Document, DocumentIndex * a_pIndex);
+        bool ParseDocument(flow::TokenStream & a_Tokenizer, FlatDocument & a_Document);
+        bool ParseDocument(flow::Tokenizer & a_Tokenizer, ParseHandler & a_Handler);
+        /** The grammar reads either a TokenStream or a Tokenizer, and fills any kind of definition */
+        template<class Tokens, class Definition>
+        bool ParseNode(Tokens & a_Tokenizer, Definition & a_Node);
+        template<class Tokens, class Definition>
+        bool ParseQuery(Tokens & a_Tokenizer, Definition & a_Query);
+        template<class Tokens>
+        bool Failed(const Grammar<Tokens> & a_Grammar, Tokens & a_Tokenizer);
+
+        void Expected(Symbol_t a_Expected, Symbol_t a_Actual, const PositionInfo &);
+        void Unexpected(Symbol_t, const PositionInfo &);
+
+        flow::SymbolTable           m_SymbolTable;
+        flow::TokenBuffer           m_Tokens;       /**< Reused by every Parse call */
+        size_t                      m_nNodeHint;    /**< Definitions in the last document, reserved up front */
+        size_t                      m_nQueryHint;
+        size_t                      m_nEventHint;   /**< Events and variables in the last flat document */
+        size_t                      m_nVariableHint;
+        size_t                      m_nRowOffset;
+        size_t                      m_nColumnOffset;
+        Arena                       m_Scratch;      /**< Spilled members of the definitions Reparse() parses, until they are kept */
+        std::string                 m_ErrorString;
+    };
+}
+
 #endif
\ No newline at end of file
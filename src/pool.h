@@ -1,41 +1,207 @@
-#ifndef _POOL_HPP_
-#define _POOL_HPP_
-
-#include <vector>
-
-namespace flow
-{
-    template<class T, size_t IncrementSize>
-    class Pool
-    {
-    public:
-        Pool() : m_nOffset(0)
-        {
-        }
-
-        size_t Insert(const T * ptr, size_t count)
-        {
-            size_t pos = (size_t) -1;
-            if (count == 0) {
-                return pos;
-            }
-            if (m_Data.size() < (m_nOffset + count)) {
-                m_Data.resize(m_Data.size() + (count < IncrementSize ? IncrementSize : count));
-            }
-            memcpy(&m_Data[m_nOffset], ptr, count);
-            pos = m_nOffset;
-            m_nOffset += count;
-            return pos;
-        }
-
-        const T * GetPointer(size_t offset) const
-        {
-            return (offset >= m_nOffset ? nullptr : &m_Data[offset]);
-        }
-    protected:
-        std::vector<T>  m_Data;
-        size_t          m_nOffset;
-    };
-}
-
-#endif
\ No newline at end of file
+#ifndef _POOL_HPP_
+#define _POOL_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace flow
+{
+    /**
+     * \brief   A chunked memory arena.
+     *
+     * Memory is carved out of a list of chunks that grow geometrically, so allocations
+     * are never moved and pointers into the arena stay valid until Reset() or Release().
+     * Reset() rewinds to the first chunk in O(1) and keeps the chunks for reuse.
+     */
+    class Arena
+    {
+    public:
+        explicit Arena(size_t a_InitialSize = 4096) : 
+            m_pFirst(nullptr), m_pCurrent(nullptr), m_pPos(nullptr), m_pEnd(nullptr), m_nInitialSize(a_InitialSize)
+        {
+        }
+
+        Arena(Arena && a_Other) noexcept : 
+            m_pFirst(a_Other.m_pFirst), m_pCurrent(a_Other.m_pCurrent), m_pPos(a_Other.m_pPos), m_pEnd(a_Other.m_pEnd), 
+            m_nInitialSize(a_Other.m_nInitialSize)
+        {
+            a_Other.m_pFirst = a_Other.m_pCurrent = nullptr;
+            a_Other.m_pPos = a_Other.m_pEnd = nullptr;
+        }
+
+        Arena & operator=(Arena && a_Other) noexcept
+        {
+            if (this != &a_Other) {
+                Release();
+                m_pFirst        = a_Other.m_pFirst;
+                m_pCurrent      = a_Other.m_pCurrent;
+                m_pPos          = a_Other.m_pPos;
+                m_pEnd          = a_Other.m_pEnd;
+                m_nInitialSize  = a_Other.m_nInitialSize;
+                a_Other.m_pFirst = a_Other.m_pCurrent = nullptr;
+                a_Other.m_pPos = a_Other.m_pEnd = nullptr;
+            }
+            return *this;
+        }
+
+        ~Arena()
+        {
+            Release();
+        }
+
+        /**
+         * \brief   Allocates uninitialized memory.
+         * \return  The memory, or nullptr if the allocation failed.
+         */
+        void * Allocate(size_t a_Size, size_t a_Alignment = alignof(std::max_align_t))
+        {
+            char * ptr = Align(m_pPos, a_Alignment);
+            if (!ptr || (ptr > m_pEnd) || (a_Size > static_cast<size_t>(m_pEnd - ptr))) {
+                return AllocateSlow(a_Size, a_Alignment);
+            }
+            m_pPos = ptr + a_Size;
+            return ptr;
+        }
+
+        /**
+         * \brief   Copies count elements into the arena.
+         * \return  A pointer to the copy, or nullptr if count is zero or the allocation failed.
+         */
+        template<class T>
+        T * Insert(const T * ptr, size_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Arena::Insert only copies trivially copyable types");
+            if (count == 0 || count > ((size_t) -1) / sizeof(T)) {
+                return nullptr;
+            }
+            T * dst = static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+            if (dst) {
+                memcpy(dst, ptr, count * sizeof(T));
+            }
+            return dst;
+        }
+
+        /**
+         * \brief   Copies a string that isn't necessarily null terminated into the arena,
+         *          and null terminates it.
+         */
+        const char * InsertString(const char * a_String, size_t a_Length)
+        {
+            char * dst = static_cast<char *>(Allocate(a_Length + 1, 1));
+            if (dst) {
+                memcpy(dst, a_String, a_Length);
+                dst[a_Length] = 0;
+            }
+            return dst;
+        }
+
+        /**
+         * \brief   Makes all the memory available again, invalidating every pointer into the arena.
+         */
+        void Reset()
+        {
+            m_pCurrent  = m_pFirst;
+            m_pPos      = m_pFirst ? m_pFirst->Data() : nullptr;
+            m_pEnd      = m_pFirst ? m_pFirst->Data() + m_pFirst->m_nSize : nullptr;
+        }
+
+        /**
+         * \brief   Returns all chunks to the system.
+         */
+        void Release()
+        {
+            Chunk * pChunk = m_pFirst;
+            while(pChunk) {
+                Chunk * pNext = pChunk->m_pNext;
+                free(pChunk);
+                pChunk = pNext;
+            }
+            m_pFirst = m_pCurrent = nullptr;
+            m_pPos = m_pEnd = nullptr;
+        }
+
+        /**
+         * \brief   Total number of bytes held by the arena.
+         */
+        size_t Capacity() const
+        {
+            size_t size = 0;
+            for(const Chunk * pChunk = m_pFirst; pChunk; pChunk = pChunk->m_pNext) {
+                size += pChunk->m_nSize;
+            }
+            return size;
+        }
+
+    protected:
+        Arena(const Arena &);
+        Arena & operator=(const Arena &);
+
+        struct Chunk {
+            Chunk *     m_pNext;
+            size_t      m_nSize;    /**< Usable bytes following the header */
+
+            char * Data() {return reinterpret_cast<char *>(this) + HeaderSize;}
+        };
+
+        /** Keeps the data of each chunk aligned for any fundamental type */
+        static const size_t HeaderSize  = (sizeof(Chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        /** Geometric growth stops here, larger requests still get a chunk of their own */
+        static const size_t MaxGrowSize = 16 * 1024 * 1024;
+
+        static char * Align(char * ptr, size_t a_Alignment)
+        {
+            return reinterpret_cast<char *>((reinterpret_cast<size_t>(ptr) + a_Alignment - 1) & ~(a_Alignment - 1));
+        }
+
+        void * AllocateSlow(size_t a_Size, size_t a_Alignment)
+        {
+            size_t required = a_Size + a_Alignment;
+            if (required < a_Size) {
+                return nullptr;
+            }
+            /** reuse the chunks that were kept by Reset() */
+            Chunk * pPrev = m_pCurrent;
+            Chunk * pChunk = m_pCurrent ? m_pCurrent->m_pNext : nullptr;
+            while(pChunk && pChunk->m_nSize < required) {
+                pPrev  = pChunk;
+                pChunk = pChunk->m_pNext;
+            }
+            if (!pChunk) {
+                size_t size = pPrev ? pPrev->m_nSize : 0;
+                size = (size == 0) ? m_nInitialSize : ((size < MaxGrowSize) ? size * 2 : size);
+                if (size < required) {
+                    size = required;
+                }
+                if (size > ((size_t) -1) - HeaderSize) {
+                    return nullptr;
+                }
+                pChunk = static_cast<Chunk *>(malloc(HeaderSize + size));
+                if (!pChunk) {
+                    return nullptr;
+                }
+                pChunk->m_pNext = nullptr;
+                pChunk->m_nSize = size;
+                if (pPrev) {
+                    pPrev->m_pNext = pChunk;
+                } else {
+                    m_pFirst = pChunk;
+                }
+            }
+            m_pCurrent  = pChunk;
+            m_pPos      = pChunk->Data();
+            m_pEnd      = m_pPos + pChunk->m_nSize;
+            return Allocate(a_Size, a_Alignment);
+        }
+
+        Chunk *     m_pFirst;
+        Chunk *     m_pCurrent;
+        char *      m_pPos;
+        char *      m_pEnd;
+        size_t      m_nInitialSize;
+    };
+}
+
+#endif
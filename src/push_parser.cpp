@@ -0,0 +1,99 @@
+#include "push_parser.h"
+#include "scan.h"
+
+namespace flow
+{
+    PushParser::PushParser(Parser & a_Parser, FlowDocument & a_Document) : 
+        m_Parser(a_Parser), m_pDocument(&a_Document), m_pHandler(nullptr), 
+        m_nStart(0), m_nScan(0), m_nDepth(0), m_nRow(0), m_nColumn(0), m_nOffset(0), m_Failed(false)
+    {
+    }
+
+    PushParser::PushParser(Parser & a_Parser, ParseHandler & a_Handler) : 
+        m_Parser(a_Parser), m_pDocument(nullptr), m_pHandler(&a_Handler), 
+        m_nStart(0), m_nScan(0), m_nDepth(0), m_nRow(0), m_nColumn(0), m_nOffset(0), m_Failed(false)
+    {
+    }
+
+    bool PushParser::Feed(const char * a_Data, size_t a_Size)
+    {
+        if (m_Failed) {
+            return false;
+        }
+
+        /** drop what was parsed before appending, at most once per chunk */
+        if (m_nStart > 0) {
+            m_Pending.erase(0, m_nStart);
+            m_nScan     -= m_nStart;
+            m_nOffset   += m_nStart;
+            m_nStart    = 0;
+        }
+        m_Pending.append(a_Data, a_Size);
+
+        const char * begin = m_Pending.data();
+        const char * end = begin + m_Pending.size();
+        const char * p = begin + m_nScan;
+        while((p = ScanBrace(p, end)) != end) {
+            if (*p == '{') {
+                ++m_nDepth;
+            } else if (m_nDepth > 0) {
+                --m_nDepth;
+            }
+            ++p;
+            /** a closing bracket at the outermost level ends a definition, or is an error */
+            if ((m_nDepth == 0) && (p[-1] == '}')) {
+                if (!ParseUntil(p - begin)) {
+                    return false;
+                }
+            }
+        }
+        m_nScan = m_Pending.size();
+        return true;
+    }
+
+    bool PushParser::Finish()
+    {
+        if (m_Failed) {
+            return false;
+        }
+        return ParseUntil(m_Pending.size());
+    }
+
+    bool PushParser::ParseUntil(size_t a_End)
+    {
+        const char * data = m_Pending.data() + m_nStart;
+        size_t size = a_End - m_nStart;
+        bool success;
+
+        m_Parser.SetRowOffset(m_nRow);
+        m_Parser.SetColumnOffset(m_nColumn);
+        if (m_pDocument) {
+            size_t spans = m_pDocument->Spans.size();
+            success = m_Parser.Parse(data, size, *m_pDocument);
+            for(size_t i = spans; i < m_pDocument->Spans.size(); ++i) {
+                m_pDocument->Spans[i].Begin += m_nOffset + m_nStart;
+                m_pDocument->Spans[i].End   += m_nOffset + m_nStart;
+            }
+        } else {
+            success = m_Parser.Parse(data, size, *m_pHandler);
+        }
+        m_Parser.SetRowOffset(0);
+        m_Parser.SetColumnOffset(0);
+        if (!success) {
+            m_Failed = true;
+            return false;
+        }
+
+        /** the next parse starts where this one ended, counted as the tokenizers count positions */
+        for(size_t i = m_nStart; i < a_End; ++i) {
+            if (m_Pending[i] == '\n') {
+                ++m_nRow;
+                m_nColumn = 0;
+            } else {
+                m_nColumn += (m_Pending[i] == '\t') ? 4 : 1;
+            }
+        }
+        m_nStart = a_End;
+        return true;
+    }
+}
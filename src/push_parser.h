@@ -0,0 +1,72 @@
+#ifndef _FLOW_PUSH_PARSER_H_
+#define _FLOW_PUSH_PARSER_H_
+
+#include <cstddef>
+#include <string>
+
+#include "parser.h"
+
+namespace flow
+{
+    /**
+     * \brief   Parses a document that arrives in chunks of any size.
+     *
+     * Chunks are collected until a top-level definition is complete, which is when the 
+     * bracket that closes it arrives, and each definition is then parsed on its own. A chunk
+     * may end anywhere, in the middle of an identifier or a number as well, since no symbol
+     * extends past a closing bracket. Only the incomplete definition is buffered, so memory 
+     * is bounded by the largest definition rather than the document.
+     *
+     * The document, the handler callbacks and the error messages, positions included, are 
+     * the same as when the whole document is parsed at once.
+     */
+    class PushParser
+    {
+    public:
+        /**
+         * \brief   Appends the definitions to a document, names are interned in a_Parser.
+         */
+        PushParser(Parser & a_Parser, FlowDocument & a_Document);
+        /**
+         * \brief   Reports the definitions to a handler as each one completes.
+         */
+        PushParser(Parser & a_Parser, ParseHandler & a_Handler);
+
+        /**
+         * \brief   Parses the definitions a chunk completes.
+         * \return  false if the document failed to parse, every later call fails as well.
+         */
+        bool Feed(const char * a_Data, size_t a_Size);
+        /**
+         * \brief   Parses what is left at the end of the document.
+         * \return  true if the whole document was parsed successfully.
+         */
+        bool Finish();
+
+        const std::string & GetErrorString() const  {return m_Parser.GetErrorString();}
+        /** Bytes held between chunks, the incomplete definition and what the last chunk completed */
+        size_t              GetBufferedSize() const {return m_Pending.size();}
+
+    protected:
+        PushParser(const PushParser &);
+        PushParser & operator=(const PushParser &);
+
+        /** Parses m_Pending from m_nStart up to a_End */
+        bool        ParseUntil(size_t a_End);
+
+        Parser &        m_Parser;
+        FlowDocument *  m_pDocument;
+        ParseHandler *  m_pHandler;
+
+        std::string     m_Pending;      /**< Bytes that haven't been parsed, and the parsed ones of the last chunk */
+        size_t          m_nStart;       /**< Where the next definition starts in m_Pending */
+        size_t          m_nScan;        /**< Where the brace scan continues in m_Pending */
+        size_t          m_nDepth;       /**< Bracket depth at m_nScan */
+        size_t          m_nRow;         /**< Row of m_nStart in the document */
+        size_t          m_nColumn;      /**< Column of m_nStart in its row */
+        size_t          m_nOffset;      /**< Offset of m_Pending in the document */
+        bool            m_Failed;
+    };
+}
+
+#endif
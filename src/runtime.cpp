@@ -0,0 +1,197 @@
+#include "runtime.h"
+
+namespace flow
+{
+    Runtime::Runtime() : m_IsDirty(false), m_nCursor(0)
+    {
+    }
+
+    bool Runtime::Load(const FlowDocument & a_Document, const SymbolTable & a_Names)
+    {
+        m_ErrorString = "";
+        m_Types.clear();
+        Clear();
+        if (!m_Index.Build(a_Document, a_Names)) {
+            m_ErrorString = m_Index.GetErrorString();
+            return false;
+        }
+
+        m_Types.resize(a_Document.Nodes.size());
+        for(size_t i = 0; i < a_Document.Nodes.size(); ++i) {
+            const FlowNode & node = a_Document.Nodes[i];
+            NodeType & type = m_Types[i];
+            for(const FlowEvent & ev : node.Events) {
+                type.Events.push_back((ev.Direction == FlowEvent::EVENT_IN) ? type.InEventCount++ : (type.OutEventCount++ | KindBit));
+            }
+            for(const FlowVariable & variable : node.Variables) {
+                if (variable.Type == FlowVariable::TYPE_FLOAT) {
+                    type.Variables.push_back(static_cast<uint32_t>(type.FloatDefaults.size()));
+                    type.FloatDefaults.push_back(variable.HasDefaultValue ? variable.DefaultValue.fValue : 0.0f);
+                } else {
+                    type.Variables.push_back(static_cast<uint32_t>(type.BoolDefaults.size()) | KindBit);
+                    type.BoolDefaults.push_back((variable.HasDefaultValue && variable.DefaultValue.bValue) ? 1 : 0);
+                }
+            }
+            type.Floats.resize(type.FloatDefaults.size());
+            type.Bools.resize(type.BoolDefaults.size());
+            type.PortOffsets.assign(1, 0);
+        }
+        return true;
+    }
+
+    void Runtime::Clear()
+    {
+        for(NodeType & type : m_Types) {
+            type.Count = 0;
+            for(std::vector<float> & column : type.Floats) {
+                column.clear();
+            }
+            for(std::vector<uint8_t> & column : type.Bools) {
+                column.clear();
+            }
+            type.PortOffsets.assign(1, 0);
+            type.Targets.clear();
+        }
+        m_Connections.clear();
+        m_IsDirty = false;
+        m_Current.clear();
+        m_Next.clear();
+        m_nCursor = 0;
+    }
+
+    uint32_t Runtime::FindType(SymbolTable::SymIndex a_Name) const
+    {
+        return m_Index.FindNode(a_Name);
+    }
+
+    uint32_t Runtime::FindMember(uint32_t a_Type, SymbolTable::SymIndex a_Name, bool a_IsEvent, bool a_Kind) const
+    {
+        if (a_Type >= m_Types.size()) {
+            return NotFound;
+        }
+        uint32_t position = a_IsEvent ? m_Index.FindNodeEvent(a_Type, a_Name) : m_Index.FindNodeVariable(a_Type, a_Name);
+        if (position == NotFound) {
+            return NotFound;
+        }
+        uint32_t member = a_IsEvent ? m_Types[a_Type].Events[position] : m_Types[a_Type].Variables[position];
+        return (((member & KindBit) != 0) == a_Kind) ? (member & ~KindBit) : NotFound;
+    }
+
+    uint32_t Runtime::FindInEvent(uint32_t a_Type, SymbolTable::SymIndex a_Name) const
+    {
+        return FindMember(a_Type, a_Name, true, false);
+    }
+
+    uint32_t Runtime::FindOutEvent(uint32_t a_Type, SymbolTable::SymIndex a_Name) const
+    {
+        return FindMember(a_Type, a_Name, true, true);
+    }
+
+    uint32_t Runtime::FindFloat(uint32_t a_Type, SymbolTable::SymIndex a_Name) const
+    {
+        return FindMember(a_Type, a_Name, false, false);
+    }
+
+    uint32_t Runtime::FindBool(uint32_t a_Type, SymbolTable::SymIndex a_Name) const
+    {
+        return FindMember(a_Type, a_Name, false, true);
+    }
+
+    bool Runtime::SetHandler(uint32_t a_Type, NodeHandler a_Handler, void * a_UserData)
+    {
+        if (a_Type >= m_Types.size()) {
+            return false;
+        }
+        m_Types[a_Type].Handler     = a_Handler;
+        m_Types[a_Type].UserData    = a_UserData;
+        return true;
+    }
+
+    bool Runtime::Create(uint32_t a_Type, NodeId & a_Node)
+    {
+        if (a_Type >= m_Types.size()) {
+            return false;
+        }
+        NodeType & type = m_Types[a_Type];
+        for(size_t i = 0; i < type.Floats.size(); ++i) {
+            type.Floats[i].push_back(type.FloatDefaults[i]);
+        }
+        for(size_t i = 0; i < type.Bools.size(); ++i) {
+            type.Bools[i].push_back(type.BoolDefaults[i]);
+        }
+        a_Node.Type     = a_Type;
+        a_Node.Index    = type.Count++;
+        /** the new instance has no connections yet, its ports are empty and come last */
+        type.PortOffsets.resize(type.PortOffsets.size() + type.OutEventCount, type.PortOffsets.back());
+        return true;
+    }
+
+    bool Runtime::Connect(NodeId a_From, uint32_t a_OutEvent, NodeId a_To, uint32_t a_InEvent)
+    {
+        if ((a_From.Type >= m_Types.size()) || (a_From.Index >= m_Types[a_From.Type].Count) || (a_OutEvent >= m_Types[a_From.Type].OutEventCount) ||
+            (a_To.Type >= m_Types.size()) || (a_To.Index >= m_Types[a_To.Type].Count) || (a_InEvent >= m_Types[a_To.Type].InEventCount)) {
+            return false;
+        }
+        Connection connection = {a_From, a_OutEvent, {a_To.Type, a_To.Index, a_InEvent}};
+        m_Connections.push_back(connection);
+        m_IsDirty = true;
+        return true;
+    }
+
+    /**
+     * Sorts the connections by the port they leave from with a counting sort, so the targets
+     * of a port are adjacent and in the order they were connected.
+     */
+    void Runtime::Wire()
+    {
+        for(NodeType & type : m_Types) {
+            type.PortOffsets.assign(static_cast<size_t>(type.Count) * type.OutEventCount + 1, 0);
+        }
+        for(const Connection & connection : m_Connections) {
+            NodeType & type = m_Types[connection.From.Type];
+            ++type.PortOffsets[static_cast<size_t>(connection.From.Index) * type.OutEventCount + connection.OutEvent + 1];
+        }
+        for(NodeType & type : m_Types) {
+            for(size_t i = 1; i < type.PortOffsets.size(); ++i) {
+                type.PortOffsets[i] += type.PortOffsets[i - 1];
+            }
+            type.Targets.resize(type.PortOffsets.back());
+        }
+        /** placing a target advances the start of its port to the start of the next one */
+        for(const Connection & connection : m_Connections) {
+            NodeType & type = m_Types[connection.From.Type];
+            type.Targets[type.PortOffsets[static_cast<size_t>(connection.From.Index) * type.OutEventCount + connection.OutEvent]++] = connection.To;
+        }
+        for(NodeType & type : m_Types) {
+            for(size_t i = type.PortOffsets.size() - 1; i > 0; --i) {
+                type.PortOffsets[i] = type.PortOffsets[i - 1];
+            }
+            type.PortOffsets[0] = 0;
+        }
+        m_IsDirty = false;
+    }
+
+    size_t Runtime::Run(size_t a_MaxEvents)
+    {
+        size_t count = 0;
+        while(count < a_MaxEvents) {
+            if (m_nCursor == m_Current.size()) {
+                if (m_Next.empty()) {
+                    break;
+                }
+                /** the events queued meanwhile are next, both buffers keep their memory */
+                m_Current.swap(m_Next);
+                m_Next.clear();
+                m_nCursor = 0;
+            }
+            QueuedEvent ev = m_Current[m_nCursor++];
+            const NodeType & type = m_Types[ev.Type];
+            if (type.Handler) {
+                NodeId node = {ev.Type, ev.Node};
+                type.Handler(*this, node, ev.Event, type.UserData);
+            }
+            ++count;
+        }
+        return count;
+    }
+}
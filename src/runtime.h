@@ -0,0 +1,180 @@
+#ifndef _FLOW_RUNTIME_H_
+#define _FLOW_RUNTIME_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "document_index.h"
+#include "parser.h"
+
+namespace flow
+{
+    /**
+     * \brief   A node instance in a Runtime.
+     */
+    struct NodeId
+    {
+        uint32_t    Type;       /**< Position of the node definition in the document */
+        uint32_t    Index;      /**< Instance of that type */
+    };
+
+    class Runtime;
+
+    /**
+     * \brief   Called for every event sent to a node of the type the handler is registered for.
+     * \param   a_InEvent   The in-event, numbered among the in-events of the definition.
+     */
+    typedef void (*NodeHandler)(Runtime & a_Runtime, NodeId a_Node, uint32_t a_InEvent, void * a_UserData);
+
+    /**
+     * \brief   Instantiates the nodes of a document and runs them by passing events between them.
+     *
+     * Every node definition of the document is a type, its instances are stored as one column
+     * per variable, floats and bools apart. Events and variables are numbered among their kind
+     * in the order of the definition: in-events, out-events, float and bool variables each
+     * start at 0, the same as the InEvent and OutEvent enums and the fields of the structs
+     * written by the CodeGenerator.
+     *
+     * Firing an out-event queues an event for every in-event it is connected to, and Run()
+     * calls the handler of each receiving node's type in the order the events were queued.
+     * The connections are compiled into a flat table per type the first time events are fired
+     * after a connection is made, so a dispatch is an indexed read and a call through a pointer.
+     * Creating an instance only appends its empty ports to the table.
+     */
+    class Runtime
+    {
+    public:
+        static const uint32_t NotFound = DocumentIndex::NotFound;
+
+        Runtime();
+
+        /**
+         * \brief   Creates the node types of a document, queries are not instantiated.
+         * \param   a_Names     The symbol table the names of the document refer to.
+         * \return  false if a name is defined twice, see GetErrorString().
+         */
+        bool Load(const FlowDocument & a_Document, const SymbolTable & a_Names);
+        /** Removes every instance, connection and queued event, the types and handlers are kept */
+        void Clear();
+
+        /** Lookups by name, all return NotFound if there is no such type, event or variable */
+        uint32_t    FindType(SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindInEvent(uint32_t a_Type, SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindOutEvent(uint32_t a_Type, SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindFloat(uint32_t a_Type, SymbolTable::SymIndex a_Name) const;
+        uint32_t    FindBool(uint32_t a_Type, SymbolTable::SymIndex a_Name) const;
+
+        size_t      TypeCount() const                           {return m_Types.size();}
+        size_t      InstanceCount(uint32_t a_Type) const        {return m_Types[a_Type].Count;}
+
+        /** Registers the handler of a type, replacing the previous one. Without one, events to the type are dropped */
+        bool        SetHandler(uint32_t a_Type, NodeHandler a_Handler, void * a_UserData = nullptr);
+
+        /**
+         * \brief   Creates an instance with the default values of its type.
+         * \return  false if there is no such type.
+         */
+        bool        Create(uint32_t a_Type, NodeId & a_Node);
+
+        /**
+         * \brief   Connects an out-event of a node to an in-event of another, or of the same node.
+         * \return  false if a node or event doesn't exist.
+         */
+        bool        Connect(NodeId a_From, uint32_t a_OutEvent, NodeId a_To, uint32_t a_InEvent);
+
+        /**
+         * \brief   Columns of a type with a value per instance, valid until the next Create() for the type.
+         */
+        float *     FloatColumn(uint32_t a_Type, uint32_t a_Float)      {return m_Types[a_Type].Floats[a_Float].data();}
+        uint8_t *   BoolColumn(uint32_t a_Type, uint32_t a_Bool)        {return m_Types[a_Type].Bools[a_Bool].data();}
+
+        float &     Float(NodeId a_Node, uint32_t a_Float)              {return m_Types[a_Node.Type].Floats[a_Float][a_Node.Index];}
+        uint8_t &   Bool(NodeId a_Node, uint32_t a_Bool)                {return m_Types[a_Node.Type].Bools[a_Bool][a_Node.Index];}
+
+        /** Queues an in-event for a node, the node and event must exist */
+        void Send(NodeId a_Node, uint32_t a_InEvent)
+        {
+            QueuedEvent ev = {a_Node.Type, a_Node.Index, a_InEvent};
+            m_Next.push_back(ev);
+        }
+
+        /** Queues an event for every in-event the out-event of a node is connected to, the node and event must exist */
+        void Fire(NodeId a_Node, uint32_t a_OutEvent)
+        {
+            if (m_IsDirty) {
+                Wire();
+            }
+            const NodeType & type = m_Types[a_Node.Type];
+            size_t port = static_cast<size_t>(a_Node.Index) * type.OutEventCount + a_OutEvent;
+            m_Next.insert(m_Next.end(), type.Targets.data() + type.PortOffsets[port], type.Targets.data() + type.PortOffsets[port + 1]);
+        }
+
+        /**
+         * \brief   Dispatches queued events, including the ones queued by the handlers.
+         * \param   a_MaxEvents     Stops after this many, which also ends a cycle of connections.
+         * \return  The number of events dispatched, the rest stay queued for the next call.
+         */
+        size_t      Run(size_t a_MaxEvents = static_cast<size_t>(-1));
+        /** Number of events waiting to be dispatched */
+        size_t      Pending() const                             {return (m_Current.size() - m_nCursor) + m_Next.size();}
+
+        const std::string & GetErrorString() const              {return m_ErrorString;}
+
+    protected:
+        Runtime(const Runtime &);
+        Runtime & operator=(const Runtime &);
+
+        /** An in-event on its way to a node, also the target of a connection */
+        struct QueuedEvent {
+            uint32_t    Type;
+            uint32_t    Node;
+            uint32_t    Event;
+        };
+
+        struct Connection {
+            NodeId      From;
+            uint32_t    OutEvent;
+            QueuedEvent To;
+        };
+
+        /** Member values carry the kind in the top bit, out-events and bools have it set */
+        static const uint32_t KindBit = 0x80000000u;
+
+        struct NodeType
+        {
+            uint32_t                InEventCount;
+            uint32_t                OutEventCount;
+            std::vector<uint32_t>   Events;         /**< Number of each event of the definition among its direction */
+            std::vector<uint32_t>   Variables;      /**< Column of each variable of the definition among its type */
+            std::vector<float>      FloatDefaults;
+            std::vector<uint8_t>    BoolDefaults;
+
+            uint32_t                Count;          /**< Instances */
+            std::vector< std::vector<float> >   Floats;
+            std::vector< std::vector<uint8_t> > Bools;
+
+            NodeHandler             Handler;
+            void *                  UserData;
+
+            std::vector<uint32_t>   PortOffsets;    /**< Targets of each out-event of each instance, Count * OutEventCount + 1 */
+            std::vector<QueuedEvent> Targets;
+        };
+
+        uint32_t    FindMember(uint32_t a_Type, SymbolTable::SymIndex a_Name, bool a_IsEvent, bool a_Kind) const;
+        /** Compiles the connections into the targets of each type */
+        void        Wire();
+
+        DocumentIndex               m_Index;
+        std::vector<NodeType>       m_Types;
+        std::vector<Connection>     m_Connections;
+        bool                        m_IsDirty;      /**< The connections changed since Wire() */
+
+        std::vector<QueuedEvent>    m_Current;      /**< The events being dispatched */
+        size_t                      m_nCursor;      /**< Next event in m_Current */
+        std::vector<QueuedEvent>    m_Next;         /**< Events queued while m_Current is dispatched */
+        std::string                 m_ErrorString;
+    };
+}
+
+#endif
@@ -0,0 +1,369 @@
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FLOW_SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FLOW_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FLOW_TARGET_AVX2
+#endif
+
+namespace flow
+{
+    static inline bool IsSpace(unsigned char c)
+    {
+        return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+    }
+
+    static inline bool IsDigit(unsigned char c)
+    {
+        return static_cast<unsigned>(c - '0') < 10;
+    }
+
+    static inline bool IsIdent(unsigned char c)
+    {
+        return IsDigit(c) || (static_cast<unsigned>((c | 0x20) - 'a') < 26) || (c == '_');
+    }
+
+    /****************************************************************************/
+    /* Scalar                                                                   */
+    /****************************************************************************/
+
+    static const char * ScalarWhitespace(const char * p, const char * end)
+    {
+        while((p != end) && IsSpace(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char * ScalarIdentifier(const char * p, const char * end)
+    {
+        while((p != end) && IsIdent(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char * ScalarDigits(const char * p, const char * end)
+    {
+        while((p != end) && IsDigit(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char * ScalarBrace(const char * p, const char * end)
+    {
+        while((p != end) && (*p != '{') && (*p != '}')) {
+            ++p;
+        }
+        return p;
+    }
+
+    static size_t ScalarNewlines(const char * p, const char * end)
+    {
+        size_t count = 0;
+        for(; p != end; ++p) {
+            count += (*p == '\n');
+        }
+        return count;
+    }
+
+#ifdef FLOW_SCAN_X86
+    static inline unsigned CountBits(unsigned mask)
+    {
+#ifdef _MSC_VER
+        return __popcnt(mask);
+#else
+        return __builtin_popcount(mask);
+#endif
+    }
+
+    static inline unsigned CountTrailingZeros(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    /****************************************************************************/
+    /* SSE2, 16 bytes at a time                                                 */
+    /****************************************************************************/
+
+    /** Bytes in [lo, lo + width), using a signed compare after biasing lo to -128 */
+    static inline __m128i InRange128(__m128i v, char lo, char width)
+    {
+        __m128i biased = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+        return _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(-128 + width)));
+    }
+
+    static inline __m128i Space128(__m128i v)
+    {
+        return _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    }
+
+    static inline __m128i Ident128(__m128i v)
+    {
+        __m128i letter = InRange128(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26);
+        return _mm_or_si128(_mm_or_si128(letter, InRange128(v, '0', 10)), _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    }
+
+    static const char * Sse2Whitespace(const char * p, const char * end)
+    {
+        while(end - p >= 16) {
+            unsigned mask = ~_mm_movemask_epi8(Space128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)))) & 0xffff;
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 16;
+        }
+        return ScalarWhitespace(p, end);
+    }
+
+    static const char * Sse2Identifier(const char * p, const char * end)
+    {
+        while(end - p >= 16) {
+            unsigned mask = ~_mm_movemask_epi8(Ident128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)))) & 0xffff;
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 16;
+        }
+        return ScalarIdentifier(p, end);
+    }
+
+    static const char * Sse2Digits(const char * p, const char * end)
+    {
+        while(end - p >= 16) {
+            unsigned mask = ~_mm_movemask_epi8(InRange128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), '0', 10)) & 0xffff;
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 16;
+        }
+        return ScalarDigits(p, end);
+    }
+
+    static const char * Sse2Brace(const char * p, const char * end)
+    {
+        const __m128i open = _mm_set1_epi8('{'), close = _mm_set1_epi8('}');
+        while(end - p >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, open), _mm_cmpeq_epi8(v, close)));
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 16;
+        }
+        return ScalarBrace(p, end);
+    }
+
+    static size_t Sse2Newlines(const char * p, const char * end)
+    {
+        const __m128i newline = _mm_set1_epi8('\n');
+        size_t count = 0;
+        while(end - p >= 16) {
+            count += CountBits(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), newline)));
+            p += 16;
+        }
+        return count + ScalarNewlines(p, end);
+    }
+
+    /****************************************************************************/
+    /* AVX2, 32 bytes at a time                                                 */
+    /****************************************************************************/
+
+    FLOW_TARGET_AVX2 static inline __m256i InRange256(__m256i v, char lo, char width)
+    {
+        __m256i biased = _mm256_add_epi8(v, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + width)), biased);
+    }
+
+    FLOW_TARGET_AVX2 static inline __m256i Space256(__m256i v)
+    {
+        return _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+    }
+
+    FLOW_TARGET_AVX2 static inline __m256i Ident256(__m256i v)
+    {
+        __m256i letter = InRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 26);
+        return _mm256_or_si256(_mm256_or_si256(letter, InRange256(v, '0', 10)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    }
+
+    FLOW_TARGET_AVX2 static const char * Avx2Whitespace(const char * p, const char * end)
+    {
+        while(end - p >= 32) {
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(Space256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)))));
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 32;
+        }
+        return Sse2Whitespace(p, end);
+    }
+
+    FLOW_TARGET_AVX2 static const char * Avx2Identifier(const char * p, const char * end)
+    {
+        while(end - p >= 32) {
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(Ident256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)))));
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 32;
+        }
+        return Sse2Identifier(p, end);
+    }
+
+    FLOW_TARGET_AVX2 static const char * Avx2Digits(const char * p, const char * end)
+    {
+        while(end - p >= 32) {
+            unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(InRange256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), '0', 10)));
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 32;
+        }
+        return Sse2Digits(p, end);
+    }
+
+    FLOW_TARGET_AVX2 static const char * Avx2Brace(const char * p, const char * end)
+    {
+        const __m256i open = _mm256_set1_epi8('{'), close = _mm256_set1_epi8('}');
+        while(end - p >= 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, open), _mm256_cmpeq_epi8(v, close))));
+            if (mask) {
+                return p + CountTrailingZeros(mask);
+            }
+            p += 32;
+        }
+        return Sse2Brace(p, end);
+    }
+
+    FLOW_TARGET_AVX2 static size_t Avx2Newlines(const char * p, const char * end)
+    {
+        const __m256i newline = _mm256_set1_epi8('\n');
+        size_t count = 0;
+        while(end - p >= 32) {
+            count += CountBits(static_cast<unsigned>(_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), newline))));
+            p += 32;
+        }
+        return count + Sse2Newlines(p, end);
+    }
+
+    static bool CpuSupportsAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        /** OSXSAVE and AVX, and the OS must save the ymm registers */
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif // FLOW_SCAN_X86
+
+    struct ScanFunctions {
+        const char * (*Whitespace)(const char *, const char *);
+        const char * (*Identifier)(const char *, const char *);
+        const char * (*Digits)(const char *, const char *);
+        const char * (*Brace)(const char *, const char *);
+        size_t       (*Newlines)(const char *, const char *);
+        ScanKernel    Kernel;
+    };
+
+    /** Statically initialized to the scalar kernel, so it's usable before the selection below runs */
+    static ScanFunctions g_Scan = {ScalarWhitespace, ScalarIdentifier, ScalarDigits, ScalarBrace, ScalarNewlines, SCAN_SCALAR};
+
+    static ScanKernel DetectScanKernel()
+    {
+#ifdef FLOW_SCAN_X86
+        return CpuSupportsAvx2() ? SCAN_AVX2 : SCAN_SSE2;
+#else
+        return SCAN_SCALAR;
+#endif
+    }
+
+    static const bool g_ScanSelected = SetScanKernel(DetectScanKernel());
+
+    const char * ScanWhitespace(const char * p, const char * end)
+    {
+        return g_Scan.Whitespace(p, end);
+    }
+
+    const char * ScanIdentifier(const char * p, const char * end)
+    {
+        return g_Scan.Identifier(p, end);
+    }
+
+    const char * ScanDigits(const char * p, const char * end)
+    {
+        return g_Scan.Digits(p, end);
+    }
+
+    const char * ScanBrace(const char * p, const char * end)
+    {
+        return g_Scan.Brace(p, end);
+    }
+
+    size_t CountNewlines(const char * p, const char * end)
+    {
+        return g_Scan.Newlines(p, end);
+    }
+
+    ScanKernel GetScanKernel()
+    {
+        return g_Scan.Kernel;
+    }
+
+    /**
+     * Not synchronized, should be called before any tokenizer is running.
+     */
+    bool SetScanKernel(ScanKernel a_Kernel)
+    {
+        switch(a_Kernel) {
+        case SCAN_SCALAR:
+            g_Scan = ScanFunctions{ScalarWhitespace, ScalarIdentifier, ScalarDigits, ScalarBrace, ScalarNewlines, SCAN_SCALAR};
+            return true;
+#ifdef FLOW_SCAN_X86
+        case SCAN_SSE2:
+            g_Scan = ScanFunctions{Sse2Whitespace, Sse2Identifier, Sse2Digits, Sse2Brace, Sse2Newlines, SCAN_SSE2};
+            return true;
+        case SCAN_AVX2:
+            if (!CpuSupportsAvx2()) {
+                return false;
+            }
+            g_Scan = ScanFunctions{Avx2Whitespace, Avx2Identifier, Avx2Digits, Avx2Brace, Avx2Newlines, SCAN_AVX2};
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
+}
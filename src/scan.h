@@ -0,0 +1,49 @@
+#ifndef _FLOW_SCAN_H_
+#define _FLOW_SCAN_H_
+
+#include <cstddef>
+
+namespace flow
+{
+    /**
+     * \brief   Implementations of the character run scanners.
+     */
+    typedef enum {
+        SCAN_SCALAR,
+        SCAN_SSE2,
+        SCAN_AVX2
+    } ScanKernel;
+
+    /**
+     * \brief   Returns the first character in [p, end) that isn't a space, tab, newline or carriage return.
+     */
+    const char * ScanWhitespace(const char * p, const char * end);
+    /**
+     * \brief   Returns the first character in [p, end) that can't be part of an identifier ([A-Za-z0-9_]).
+     */
+    const char * ScanIdentifier(const char * p, const char * end);
+    /**
+     * \brief   Returns the first character in [p, end) that isn't a decimal digit.
+     */
+    const char * ScanDigits(const char * p, const char * end);
+
+    /**
+     * \brief   Returns the first '{' or '}' in [p, end), or end.
+     */
+    const char * ScanBrace(const char * p, const char * end);
+    /**
+     * \brief   Returns the number of newline characters in [p, end).
+     */
+    size_t      CountNewlines(const char * p, const char * end);
+
+    /**
+     * \brief   The kernel selected for this CPU, the widest one the CPU supports.
+     */
+    ScanKernel  GetScanKernel();
+    /**
+     * \brief   Overrides the kernel selection, returns false if the CPU doesn't support it.
+     */
+    bool        SetScanKernel(ScanKernel);
+}
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef _FLOW_SMALL_VECTOR_H_
+#define _FLOW_SMALL_VECTOR_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "pool.h"
+
+namespace flow
+{
+    /**
+     * \brief   A vector that stores up to N elements inside itself.
+     *
+     * Only a vector that grows beyond N elements allocates, it then moves to the heap
+     * like a std::vector, or to an Arena if one is passed to push_back(). Memory from an
+     * arena is never freed by the vector, it belongs to the arena until the arena is reset.
+     * Moving a vector steals a heap buffer, but moves the elements of an inline one and of one
+     * in an arena, to the heap if they don't fit inline, since the arena may be reset while the
+     * moved-to vector lives on. swap() exchanges buffers of either kind, for vectors that live
+     * as long as the arena does. Copies always spill to the heap.
+     */
+    template<class T, size_t N>
+    class SmallVector
+    {
+    public:
+        typedef T           value_type;
+        typedef T *         iterator;
+        typedef const T *   const_iterator;
+        typedef size_t      size_type;
+
+        SmallVector() : m_pData(Inline()), m_nSize(0), m_nCapacity(N), m_IsArena(false)
+        {
+        }
+
+        SmallVector(const SmallVector & a_Other) : m_pData(Inline()), m_nSize(0), m_nCapacity(N), m_IsArena(false)
+        {
+            reserve(a_Other.m_nSize);
+            for(const T & item : a_Other) {
+                new (m_pData + m_nSize) T(item);
+                ++m_nSize;
+            }
+        }
+
+        SmallVector(SmallVector && a_Other) noexcept : m_pData(Inline()), m_nSize(0), m_nCapacity(N), m_IsArena(false)
+        {
+            MoveFrom(a_Other);
+        }
+
+        ~SmallVector()
+        {
+            clear();
+            Deallocate();
+        }
+
+        SmallVector & operator=(const SmallVector & a_Other)
+        {
+            if (this != &a_Other) {
+                clear();
+                reserve(a_Other.m_nSize);
+                for(const T & item : a_Other) {
+                    new (m_pData + m_nSize) T(item);
+                    ++m_nSize;
+                }
+            }
+            return *this;
+        }
+
+        SmallVector & operator=(SmallVector && a_Other) noexcept
+        {
+            if (this != &a_Other) {
+                clear();
+                Deallocate();
+                MoveFrom(a_Other);
+            }
+            return *this;
+        }
+
+        void push_back(const T & a_Value)       {emplace_back(a_Value);}
+        void push_back(T && a_Value)            {emplace_back(std::move(a_Value));}
+
+        /** Appends an element, spilling to memory from the arena instead of the heap */
+        void push_back(const T & a_Value, Arena & a_Arena)
+        {
+            if (m_nSize == m_nCapacity) {
+                T value(a_Value);
+                Grow(m_nCapacity * 2, &a_Arena);
+                new (m_pData + m_nSize++) T(std::move(value));
+            } else {
+                new (m_pData + m_nSize++) T(a_Value);
+            }
+        }
+
+        /** Exchanges the elements, a spilled vector hands over its buffer even if it is in an arena */
+        void swap(SmallVector & a_Other)
+        {
+            if (this != &a_Other) {
+                SmallVector temp;
+                temp.Steal(*this);
+                Steal(a_Other);
+                a_Other.Steal(temp);
+            }
+        }
+
+        /** Moves spilled elements to memory from the arena, so they no longer depend on where they were */
+        void relocate(Arena & a_Arena)
+        {
+            if (!is_inline()) {
+                Grow(m_nCapacity, &a_Arena);
+            }
+        }
+
+        template<class... Args>
+        T & emplace_back(Args &&... a_Args)
+        {
+            if (m_nSize == m_nCapacity) {
+                /** the argument may refer to an element, so construct it before growing */
+                T value(std::forward<Args>(a_Args)...);
+                Grow(m_nCapacity * 2);
+                return *new (m_pData + m_nSize++) T(std::move(value));
+            }
+            return *new (m_pData + m_nSize++) T(std::forward<Args>(a_Args)...);
+        }
+
+        void pop_back()
+        {
+            m_pData[--m_nSize].~T();
+        }
+
+        /** Destroys the elements, heap memory is kept for reuse */
+        void clear()
+        {
+            for(size_t i = 0; i < m_nSize; ++i) {
+                m_pData[i].~T();
+            }
+            m_nSize = 0;
+        }
+
+        void reserve(size_t a_Capacity)
+        {
+            if (a_Capacity > m_nCapacity) {
+                Grow(a_Capacity);
+            }
+        }
+
+        size_t      size() const                        {return m_nSize;}
+        size_t      capacity() const                    {return m_nCapacity;}
+        bool        empty() const                       {return m_nSize == 0;}
+        /** Indicates if the elements are stored inside the vector */
+        bool        is_inline() const                   {return m_pData == Inline();}
+        /** Indicates if the elements are stored in an arena */
+        bool        is_arena() const                    {return m_IsArena;}
+
+        T *         data()                              {return m_pData;}
+        const T *   data() const                        {return m_pData;}
+        iterator        begin()                         {return m_pData;}
+        iterator        end()                           {return m_pData + m_nSize;}
+        const_iterator  begin() const                   {return m_pData;}
+        const_iterator  end() const                     {return m_pData + m_nSize;}
+        T &         operator[](size_t a_Index)          {return m_pData[a_Index];}
+        const T &   operator[](size_t a_Index) const    {return m_pData[a_Index];}
+        T &         front()                             {return m_pData[0];}
+        const T &   front() const                       {return m_pData[0];}
+        T &         back()                              {return m_pData[m_nSize - 1];}
+        const T &   back() const                        {return m_pData[m_nSize - 1];}
+
+    protected:
+        T *         Inline()                            {return reinterpret_cast<T *>(m_Inline);}
+        const T *   Inline() const                      {return reinterpret_cast<const T *>(m_Inline);}
+
+        void Grow(size_t a_Capacity, Arena * a_pArena = nullptr)
+        {
+            T * pData;
+            if (a_pArena) {
+                pData = static_cast<T *>(a_pArena->Allocate(a_Capacity * sizeof(T), alignof(T)));
+                if (!pData) {
+                    throw std::bad_alloc();
+                }
+            } else {
+                pData = static_cast<T *>(::operator new(a_Capacity * sizeof(T)));
+            }
+            for(size_t i = 0; i < m_nSize; ++i) {
+                new (pData + i) T(std::move(m_pData[i]));
+                m_pData[i].~T();
+            }
+            Deallocate();
+            m_pData     = pData;
+            m_nCapacity = a_Capacity;
+            m_IsArena   = (a_pArena != nullptr);
+        }
+
+        void Deallocate()
+        {
+            if (!is_inline()) {
+                if (!m_IsArena) {
+                    ::operator delete(m_pData);
+                }
+                m_pData     = Inline();
+                m_nCapacity = N;
+                m_IsArena   = false;
+            }
+        }
+
+        /** Expects this vector to be empty and inline */
+        void MoveFrom(SmallVector & a_Other)
+        {
+            if (a_Other.m_IsArena) {
+                reserve(a_Other.m_nSize);
+                for(size_t i = 0; i < a_Other.m_nSize; ++i) {
+                    new (m_pData + i) T(std::move(a_Other.m_pData[i]));
+                }
+                m_nSize = a_Other.m_nSize;
+                a_Other.clear();
+            } else {
+                Steal(a_Other);
+            }
+        }
+
+        /** Takes the elements and the buffer of another vector, expects this vector to be empty and inline */
+        void Steal(SmallVector & a_Other)
+        {
+            if (a_Other.is_inline()) {
+                for(size_t i = 0; i < a_Other.m_nSize; ++i) {
+                    new (m_pData + i) T(std::move(a_Other.m_pData[i]));
+                }
+                m_nSize = a_Other.m_nSize;
+                a_Other.clear();
+            } else {
+                m_pData             = a_Other.m_pData;
+                m_nSize             = a_Other.m_nSize;
+                m_nCapacity         = a_Other.m_nCapacity;
+                m_IsArena           = a_Other.m_IsArena;
+                a_Other.m_pData     = a_Other.Inline();
+                a_Other.m_nSize     = 0;
+                a_Other.m_nCapacity = N;
+                a_Other.m_IsArena   = false;
+            }
+        }
+
+        T *         m_pData;
+        size_t      m_nSize;
+        size_t      m_nCapacity;
+        bool        m_IsArena;      /**< m_pData is owned by an arena */
+        alignas(T) unsigned char m_Inline[N * sizeof(T)];
+    };
+}
+
+#endif
@@ -0,0 +1,636 @@
+#ifndef _FLOW_STATIC_DOCUMENT_H_
+#define _FLOW_STATIC_DOCUMENT_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "grammar.h"
+#include "parser.h"
+#include "token_tables.h"
+
+namespace flow
+{
+    /**
+     * \brief   The sizes of a document parsed at compile time, or where the parse failed.
+     */
+    struct StaticDocumentSizes
+    {
+        size_t              Nodes;
+        size_t              Queries;
+        size_t              Events;
+        size_t              Variables;
+        size_t              Names;          /**< Identifiers in the source, duplicates included */
+        size_t              Characters;     /**< Characters of those identifiers, null terminators included */
+
+        GrammarStatus       Status;
+        size_t              Row;            /**< Position of the error, the same as the Parser reports */
+        size_t              Col;
+        Symbol_t            Expected;       /**< Only valid for GRAMMAR_EXPECTED */
+        Symbol_t            Actual;
+    };
+
+    /**
+     * \brief   A document parsed at compile time into read-only tables.
+     *
+     * The tables have the layout of a FlatDocument. Names are symbols in the document's own
+     * name table, numbered in order of first appearance like a Parser's symbol table, so a
+     * document parsed by a new Parser ends up with the same symbol indices. The name table is
+     * sized for every identifier in the source, NameCount says how many are distinct.
+     */
+    template<size_t NodeCount, size_t QueryCount, size_t EventCount, size_t VariableCount, size_t NameCapacity, size_t CharacterCapacity>
+    struct StaticDocument
+    {
+        std::array< FlatDefinition, NodeCount >     Nodes;
+        std::array< FlatDefinition, QueryCount >    Queries;
+        std::array< FlatEvent, EventCount >         Events;
+        std::array< FlatVariable, VariableCount >   Variables;
+        std::array< uint32_t, NameCapacity >        NameOffsets;    /**< Offset of each name in Strings */
+        std::array< uint32_t, NameCapacity >        NameLengths;
+        std::array< char, CharacterCapacity >       Strings;        /**< Null terminated names */
+        size_t                                      NameCount;
+
+        /** Returns the name of a symbol, or an empty view */
+        constexpr std::string_view GetString(SymbolTable::SymIndex a_Index) const
+        {
+            return (a_Index < NameCount) ? std::string_view(&Strings[NameOffsets[a_Index]], NameLengths[a_Index]) : std::string_view();
+        }
+    };
+
+    /**
+     * \brief   An unsigned integer wide enough to round any real literal exactly during
+     *          constant evaluation. Limbs are little endian.
+     */
+    struct StaticBigInt
+    {
+        static constexpr size_t Limbs = 48;
+
+        std::array< uint32_t, Limbs >   Limb;
+        size_t                          Size;   /**< Limbs in use, the top one is nonzero */
+
+        constexpr explicit StaticBigInt(uint32_t a_Value = 0) : Limb(), Size(a_Value ? 1 : 0)
+        {
+            Limb[0] = a_Value;
+        }
+
+        constexpr void MulAdd(uint32_t a_Mul, uint32_t a_Add)
+        {
+            uint64_t carry = a_Add;
+            for(size_t i = 0; i < Size; ++i) {
+                carry += static_cast<uint64_t>(Limb[i]) * a_Mul;
+                Limb[i] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            if (carry != 0) {
+                Limb[Size++] = static_cast<uint32_t>(carry);
+            }
+        }
+
+        constexpr void ShiftLeft(size_t a_Bits)
+        {
+            if (Size == 0) {
+                return;
+            }
+            size_t words = a_Bits / 32, bits = a_Bits % 32;
+            Limb[Size + words] = 0;
+            for(size_t i = Size; i-- > 0;) {
+                uint64_t wide = static_cast<uint64_t>(Limb[i]) << bits;
+                Limb[i + words + 1] |= static_cast<uint32_t>(wide >> 32);
+                Limb[i + words]     = static_cast<uint32_t>(wide);
+            }
+            for(size_t i = 0; i < words; ++i) {
+                Limb[i] = 0;
+            }
+            Size += words + 1;
+            while((Size != 0) && (Limb[Size - 1] == 0)) {
+                --Size;
+            }
+        }
+
+        constexpr size_t Bits() const
+        {
+            size_t bits = Size * 32;
+            for(uint32_t top = Size ? Limb[Size - 1] : 0x80000000u; !(top & 0x80000000u); top <<= 1) {
+                --bits;
+            }
+            return bits;
+        }
+
+        constexpr int Compare(const StaticBigInt & a_Other) const
+        {
+            if (Size != a_Other.Size) {
+                return (Size < a_Other.Size) ? -1 : 1;
+            }
+            for(size_t i = Size; i-- > 0;) {
+                if (Limb[i] != a_Other.Limb[i]) {
+                    return (Limb[i] < a_Other.Limb[i]) ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        /** Subtracts a value that isn't larger */
+        constexpr void Subtract(const StaticBigInt & a_Other)
+        {
+            int64_t borrow = 0;
+            for(size_t i = 0; i < Size; ++i) {
+                int64_t diff = static_cast<int64_t>(Limb[i]) - ((i < a_Other.Size) ? a_Other.Limb[i] : 0) - borrow;
+                borrow  = (diff < 0) ? 1 : 0;
+                Limb[i] = static_cast<uint32_t>(diff + (borrow << 32));
+            }
+            while((Size != 0) && (Limb[Size - 1] == 0)) {
+                --Size;
+            }
+        }
+    };
+
+    /**
+     * \brief   Splits a source into symbols during constant evaluation, exactly like the Tokenizer
+     *          and with the same tables. Identifiers are interned through Names::Intern().
+     */
+    template<class Names>
+    class StaticTokenizer
+    {
+    public:
+        constexpr StaticTokenizer(std::string_view a_Source, Names & a_Names) :
+            m_Source(a_Source), m_nCur(0), m_HasPeeked(false), m_NextSym(T_EOF), m_SymbolIndex(0), m_IntValue(0), m_RealValue(0), m_Names(a_Names)
+        {
+        }
+
+        constexpr Symbol_t GetSym()
+        {
+            if (m_HasPeeked) {
+                m_HasPeeked = false;
+                return m_NextSym;
+            }
+            return Scan();
+        }
+
+        constexpr Symbol_t Peek()
+        {
+            if (!m_HasPeeked) {
+                m_NextSym   = Scan();
+                m_HasPeeked = true;
+            }
+            return m_NextSym;
+        }
+
+        constexpr uint32_t          SymIndex() const    {return m_SymbolIndex;}
+        constexpr int               IntValue() const    {return m_IntValue;}
+        constexpr float             RealValue() const   {return m_RealValue;}
+
+        /** The position after the last scanned symbol, tabs count as 4 columns */
+        constexpr void Position(size_t & a_Row, size_t & a_Col) const
+        {
+            a_Row = 0;
+            a_Col = 0;
+            for(size_t i = 0; i < m_nCur; ++i) {
+                if (m_Source[i] == '\n') {
+                    ++a_Row;
+                    a_Col = 0;
+                } else {
+                    a_Col += (m_Source[i] == '\t') ? 4 : 1;
+                }
+            }
+        }
+
+    protected:
+        static constexpr bool Is(char c, unsigned a_Class)  {return (CharTable.Classes[static_cast<unsigned char>(c)] & a_Class) != 0;}
+        static constexpr bool IsDigit(char c)               {return Is(c, CC_DIGIT);}
+
+        constexpr size_t SkipDigits(size_t p) const
+        {
+            while((p != m_Source.size()) && IsDigit(m_Source[p])) {
+                ++p;
+            }
+            return p;
+        }
+
+        /** Converts digits to an int, false if it overflows like std::from_chars */
+        static constexpr bool ToInt(std::string_view a_Text, int & a_Value)
+        {
+            int value = 0;
+            for(char c : a_Text) {
+                int digit = c - '0';
+                if (value > (0x7fffffff - digit) / 10) {
+                    return false;
+                }
+                value = value * 10 + digit;
+            }
+            a_Value = value;
+            return true;
+        }
+
+        /**
+         * Converts a real to the nearest float, ties to even, false if it rounds to infinity or
+         * a nonzero value rounds to zero, exactly like std::from_chars. The value is compared as
+         * the fraction of two big integers, so there is a single rounding for any literal.
+         */
+        static constexpr bool ToReal(std::string_view a_Text, float & a_Value)
+        {
+            /** digits past the first 120 significant ones only matter for breaking ties */
+            constexpr int MaxDigits = 120;
+            StaticBigInt num;
+            int digits = 0, exponent = 0;
+            bool sticky = false;
+            size_t i = 0;
+            for(bool fraction = false; i != a_Text.size(); ++i) {
+                if (!fraction && (a_Text[i] == '.')) {
+                    fraction = true;
+                    continue;
+                }
+                if (!IsDigit(a_Text[i])) {
+                    break;
+                }
+                uint32_t digit = static_cast<uint32_t>(a_Text[i] - '0');
+                if (digits < MaxDigits) {
+                    num.MulAdd(10, digit);
+                    digits += (num.Size != 0) ? 1 : 0;
+                    exponent -= fraction ? 1 : 0;
+                } else {
+                    sticky |= (digit != 0);
+                    exponent += fraction ? 0 : 1;
+                }
+            }
+            if ((i != a_Text.size()) && ((a_Text[i] == 'e') || (a_Text[i] == 'E'))) {
+                bool negative = (a_Text[++i] == '-');
+                i += ((a_Text[i] == '-') || (a_Text[i] == '+')) ? 1 : 0;
+                int value = 0;
+                for(; i != a_Text.size(); ++i) {
+                    value = (value < 10000) ? (value * 10 + (a_Text[i] - '0')) : value;
+                }
+                exponent += negative ? -value : value;
+            }
+            if (num.Size == 0) {
+                a_Value = 0;
+                return true;
+            }
+            if (sticky) {
+                num.MulAdd(10, 1);
+                ++digits;
+                --exponent;
+            }
+            /** at least 1e39 overflows, below 1e-46 is less than half the smallest denormal */
+            if ((digits + exponent > 39) || (digits + exponent < -45)) {
+                return false;
+            }
+
+            /** value = num / den */
+            StaticBigInt den(1);
+            for(; exponent > 0; --exponent) {
+                num.MulAdd(10, 0);
+            }
+            for(; exponent < 0; ++exponent) {
+                den.MulAdd(10, 0);
+            }
+
+            /** pick the binary exponent that gives a 24 bit quotient, or the denormal one */
+            int binary = static_cast<int>(num.Bits()) - static_cast<int>(den.Bits()) - 24;
+            StaticBigInt top = num, bottom = den;
+            for(;;) {
+                binary = (binary < -149) ? -149 : binary;
+                top     = num;
+                bottom  = den;
+                if (binary < 0) {
+                    top.ShiftLeft(static_cast<size_t>(-binary));
+                } else {
+                    bottom.ShiftLeft(static_cast<size_t>(binary));
+                }
+                StaticBigInt limit = bottom;
+                limit.ShiftLeft(24);
+                if (top.Compare(limit) >= 0) {
+                    ++binary;
+                    continue;
+                }
+                limit = bottom;
+                limit.ShiftLeft(23);
+                if ((binary > -149) && (top.Compare(limit) < 0)) {
+                    --binary;
+                    continue;
+                }
+                break;
+            }
+
+            uint32_t quotient = 0;
+            for(int bit = 23; bit >= 0; --bit) {
+                StaticBigInt part = bottom;
+                part.ShiftLeft(static_cast<size_t>(bit));
+                if (top.Compare(part) >= 0) {
+                    top.Subtract(part);
+                    quotient |= 1u << bit;
+                }
+            }
+            /** top is now the remainder, round half to even */
+            top.ShiftLeft(1);
+            int half = top.Compare(bottom);
+            if ((half > 0) || ((half == 0) && (quotient & 1))) {
+                if (++quotient == (1u << 24)) {
+                    quotient >>= 1;
+                    ++binary;
+                }
+            }
+            if ((quotient == 0) || (binary > 127 - 23)) {
+                return false;
+            }
+
+            /** every step is exact, the result is representable */
+            double result = quotient;
+            for(; binary > 0; --binary) {
+                result *= 2;
+            }
+            for(; binary < 0; ++binary) {
+                result /= 2;
+            }
+            a_Value = static_cast<float>(result);
+            return true;
+        }
+
+        constexpr Symbol_t Scan()
+        {
+            size_t p = m_nCur, end = m_Source.size();
+            while((p != end) && Is(m_Source[p], CC_SPACE)) {
+                ++p;
+            }
+            if (p == end) {
+                m_nCur = p;
+                return T_EOF;
+            }
+
+            size_t start = p;
+            char c = m_Source[p++];
+            if (Is(c, CC_SINGLE)) {
+                m_nCur = p;
+                return CharTable.Single[static_cast<unsigned char>(c)];
+            }
+
+            Symbol_t sym = T_FAILURE;
+            if (c == '=') {
+                sym = ((p != end) && (m_Source[p] == '=')) ? (++p, T_EQUAL) : T_ASSIGN;
+            } else if (c == '<') {
+                sym = ((p != end) && (m_Source[p] == '=')) ? (++p, T_LEQ) : T_LESS;
+            } else if (c == '>') {
+                sym = ((p != end) && (m_Source[p] == '=')) ? (++p, T_GEQ) : T_GRT;
+            } else if (IsDigit(c)) {
+                bool real = false;
+                p = SkipDigits(p);
+                if ((p != end) && (m_Source[p] == '.')) {
+                    real = true;
+                    p = SkipDigits(p + 1);
+                }
+                if ((p != end) && ((m_Source[p] == 'e') || (m_Source[p] == 'E'))) {
+                    size_t exponent = p + 1;
+                    if ((exponent != end) && ((m_Source[exponent] == '+') || (m_Source[exponent] == '-'))) {
+                        ++exponent;
+                    }
+                    if ((exponent != end) && IsDigit(m_Source[exponent])) {
+                        real = true;
+                        p = SkipDigits(exponent);
+                    }
+                }
+                std::string_view text = m_Source.substr(start, p - start);
+                if (real) {
+                    sym = ToReal(text, m_RealValue) ? T_REAL : T_FAILURE;
+                    if ((p != end) && (m_Source[p] == 'f')) {
+                        ++p;
+                    }
+                } else {
+                    sym = ToInt(text, m_IntValue) ? T_INTEGER : T_FAILURE;
+                }
+            } else if (Is(c, CC_IDENT_START)) {
+                while((p != end) && Is(m_Source[p], CC_IDENT)) {
+                    ++p;
+                }
+                sym = MatchKeyword(m_Source.data() + start, p - start);
+                if (sym == T_IDENT) {
+                    m_SymbolIndex = m_Names.Intern(m_Source.substr(start, p - start));
+                }
+            }
+            m_nCur = p;
+            return sym;
+        }
+
+        std::string_view    m_Source;
+        size_t              m_nCur;
+        bool                m_HasPeeked;
+        Symbol_t            m_NextSym;
+        uint32_t            m_SymbolIndex;
+        int                 m_IntValue;
+        float               m_RealValue;
+        Names &             m_Names;
+    };
+
+    /**
+     * \brief   Reports a definition to a StaticParser's builder in the flat layout, standing in
+     *          for a FlowNode or FlowQuery while one is parsed.
+     */
+    template<class Builder>
+    struct StaticDefinition
+    {
+        Builder &   Target;
+        bool        IsQuery;
+
+        constexpr bool SetName(uint32_t a_Name)
+        {
+            Target.BeginDefinition(IsQuery, a_Name);
+            return true;
+        }
+        constexpr bool AddEvent(const FlowEvent & a_Event)
+        {
+            Target.AddEvent(MakeFlatEvent(a_Event));
+            return true;
+        }
+        constexpr bool AddVariable(const FlowVariable & a_Variable)
+        {
+            Target.AddVariable(MakeFlatVariable(a_Variable));
+            return true;
+        }
+    };
+
+    /**
+     * \brief   Runs the Parser's grammar during constant evaluation, reporting the definitions
+     *          to a builder and stopping at the first error with the Parser's position.
+     */
+    template<class Builder>
+    class StaticParser
+    {
+    public:
+        constexpr StaticParser(std::string_view a_Source, Builder & a_Builder) :
+            Status(GRAMMAR_OK), Row(0), Col(0), Expected(T_EOF), Actual(T_EOF), m_Tokenizer(a_Source, a_Builder), m_Builder(a_Builder)
+        {
+        }
+
+        constexpr bool ParseDocument()
+        {
+            Symbol_t sym = m_Tokenizer.Peek();
+            while(sym != T_EOF) {
+                Grammar< StaticTokenizer<Builder> > grammar(m_Tokenizer);
+                StaticDefinition<Builder> definition = {m_Builder, sym == T_KEYWORD_QUERY};
+                bool success = (sym == T_KEYWORD_NODE) ? grammar.ParseNode(definition) :
+                    ((sym == T_KEYWORD_QUERY) ? grammar.ParseQuery(definition) : grammar.Unexpected(sym));
+                if (!success) {
+                    Status      = grammar.Status;
+                    Expected    = grammar.Expected;
+                    Actual      = grammar.Actual;
+                    m_Tokenizer.Position(Row, Col);
+                    return false;
+                }
+                sym = m_Tokenizer.Peek();
+            }
+            return true;
+        }
+
+        /** The outcome, as in StaticDocumentSizes */
+        GrammarStatus       Status;
+        size_t              Row;
+        size_t              Col;
+        Symbol_t            Expected;
+        Symbol_t            Actual;
+
+    protected:
+        StaticTokenizer<Builder>    m_Tokenizer;
+        Builder &                   m_Builder;
+    };
+
+    /**
+     * \brief   Counts what a document needs, the first pass of a compile-time parse.
+     */
+    struct StaticDocumentCounter
+    {
+        StaticDocumentSizes Sizes;
+
+        constexpr uint32_t Intern(std::string_view a_Name)
+        {
+            Sizes.Characters += a_Name.size() + 1;
+            return static_cast<uint32_t>(Sizes.Names++);
+        }
+        constexpr void BeginDefinition(bool a_IsQuery, uint32_t)
+        {
+            ++(a_IsQuery ? Sizes.Queries : Sizes.Nodes);
+        }
+        constexpr void AddEvent(const FlatEvent &)          {++Sizes.Events;}
+        constexpr void AddVariable(const FlatVariable &)    {++Sizes.Variables;}
+    };
+
+    /** Slots of the name table a StaticDocumentBuilder interns through, at most half full */
+    constexpr size_t StaticNameSlots(size_t a_Names)
+    {
+        size_t slots = 1;
+        while(slots < a_Names * 2) {
+            slots *= 2;
+        }
+        return slots;
+    }
+
+    /**
+     * \brief   Fills a StaticDocument, the second pass of a compile-time parse.
+     */
+    template<class Document, size_t SlotCount>
+    struct StaticDocumentBuilder
+    {
+        Document &          Target;
+        FlatDefinition *    pDefinition;    /**< The definition being parsed */
+        size_t              Nodes;
+        size_t              Queries;
+        size_t              Events;
+        size_t              Variables;
+        size_t              Characters;
+        std::array< uint32_t, SlotCount >   Slots;  /**< Open addressing over the names, symbol index + 1 or 0 for empty */
+
+        constexpr uint32_t Intern(std::string_view a_Name)
+        {
+            uint32_t hash = 2166136261u;
+            for(char c : a_Name) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+            }
+            size_t slot = hash & (SlotCount - 1);
+            for(; Slots[slot] != 0; slot = (slot + 1) & (SlotCount - 1)) {
+                if (a_Name == Target.GetString(Slots[slot] - 1)) {
+                    return Slots[slot] - 1;
+                }
+            }
+            Target.NameOffsets[Target.NameCount] = static_cast<uint32_t>(Characters);
+            Target.NameLengths[Target.NameCount] = static_cast<uint32_t>(a_Name.size());
+            for(char c : a_Name) {
+                Target.Strings[Characters++] = c;
+            }
+            Target.Strings[Characters++] = 0;
+            Slots[slot] = static_cast<uint32_t>(++Target.NameCount);
+            return Slots[slot] - 1;
+        }
+        constexpr void BeginDefinition(bool a_IsQuery, uint32_t a_Name)
+        {
+            pDefinition = a_IsQuery ? &Target.Queries[Queries++] : &Target.Nodes[Nodes++];
+            pDefinition->Name           = a_Name;
+            pDefinition->FirstEvent     = static_cast<uint32_t>(Events);
+            pDefinition->FirstVariable  = static_cast<uint32_t>(Variables);
+        }
+        constexpr void AddEvent(const FlatEvent & a_Event)
+        {
+            Target.Events[Events++] = a_Event;
+            ++pDefinition->EventCount;
+        }
+        constexpr void AddVariable(const FlatVariable & a_Variable)
+        {
+            Target.Variables[Variables++] = a_Variable;
+            ++pDefinition->VariableCount;
+        }
+    };
+
+    /**
+     * \brief   Parses a source during constant evaluation and returns the sizes its tables
+     *          need, or the position of the first error.
+     */
+    constexpr StaticDocumentSizes MeasureStaticDocument(std::string_view a_Source)
+    {
+        StaticDocumentCounter counter = {};
+        StaticParser<StaticDocumentCounter> parser(a_Source, counter);
+        parser.ParseDocument();
+        counter.Sizes.Status    = parser.Status;
+        counter.Sizes.Row       = parser.Row;
+        counter.Sizes.Col       = parser.Col;
+        counter.Sizes.Expected  = parser.Expected;
+        counter.Sizes.Actual    = parser.Actual;
+        return counter.Sizes;
+    }
+
+    /**
+     * \brief   Parses a source during constant evaluation into tables of the measured sizes.
+     */
+    template<size_t NodeCount, size_t QueryCount, size_t EventCount, size_t VariableCount, size_t NameCapacity, size_t CharacterCapacity>
+    constexpr StaticDocument<NodeCount, QueryCount, EventCount, VariableCount, NameCapacity, CharacterCapacity>
+        CompileStaticDocument(std::string_view a_Source)
+    {
+        typedef StaticDocument<NodeCount, QueryCount, EventCount, VariableCount, NameCapacity, CharacterCapacity> Document;
+        Document document = {};
+        typedef StaticDocumentBuilder<Document, StaticNameSlots(NameCapacity)> Builder;
+        Builder builder = {document, nullptr, 0, 0, 0, 0, 0, {}};
+        StaticParser<Builder> parser(a_Source, builder);
+        parser.ParseDocument();
+        return document;
+    }
+
+    /**
+     * \brief   Fails the build when a compile-time parse fails, the template arguments in the
+     *          compiler's message tell what was expected and found where.
+     */
+    template<GrammarStatus Status, size_t Row, size_t Col, Symbol_t Expected, Symbol_t Actual>
+    struct StaticParseCheck
+    {
+        static_assert(Status == GRAMMAR_OK, "flow definition failed to parse, see the Row and Col of StaticParseCheck");
+        static constexpr bool Ok = (Status == GRAMMAR_OK);
+    };
+}
+
+/**
+ * \brief   Defines a_Name as a constexpr StaticDocument parsed from a_Source, which is a string
+ *          literal or a constexpr character array. A grammar error fails the build.
+ */
+#define FLOW_STATIC_DOCUMENT(a_Name, a_Source)                                                                  \
+    static constexpr flow::StaticDocumentSizes a_Name##Sizes = flow::MeasureStaticDocument(a_Source);           \
+    [[maybe_unused]] static constexpr bool a_Name##Checked = flow::StaticParseCheck<a_Name##Sizes.Status,       \
+        a_Name##Sizes.Row, a_Name##Sizes.Col, a_Name##Sizes.Expected, a_Name##Sizes.Actual>::Ok;                \
+    static constexpr auto a_Name = flow::CompileStaticDocument<a_Name##Sizes.Nodes, a_Name##Sizes.Queries,     \
+        a_Name##Sizes.Events, a_Name##Sizes.Variables, a_Name##Sizes.Names, a_Name##Sizes.Characters>(a_Source)
+
+#endif
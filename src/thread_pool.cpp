@@ -0,0 +1,127 @@
+#include "thread_pool.h"
+
+namespace flow
+{
+    ThreadPool::ThreadPool(unsigned a_Threads) : 
+        m_nWorkers(a_Threads), m_pFunction(nullptr), m_nGeneration(0), m_nActive(0), m_Stop(false)
+    {
+        if (m_nWorkers == 0) {
+            m_nWorkers = std::thread::hardware_concurrency();
+        }
+        if (m_nWorkers == 0) {
+            m_nWorkers = 1;
+        }
+        m_Ranges.reset(new Range[m_nWorkers]);
+        for(unsigned i = 0; i < m_nWorkers; ++i) {
+            m_Ranges[i].Begin = m_Ranges[i].End = 0;
+        }
+        for(unsigned i = 1; i < m_nWorkers; ++i) {
+            m_Threads.emplace_back(&ThreadPool::WorkerMain, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_Stop = true;
+        }
+        m_Wake.notify_all();
+        for(std::thread & thread : m_Threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::ForEach(size_t a_Count, const Function & a_Function)
+    {
+        std::lock_guard<std::mutex> serialize(m_ForEachLock);
+        for(unsigned i = 0; i < m_nWorkers; ++i) {
+            std::lock_guard<std::mutex> lock(m_Ranges[i].Lock);
+            m_Ranges[i].Begin   = a_Count * i / m_nWorkers;
+            m_Ranges[i].End     = a_Count * (i + 1) / m_nWorkers;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_pFunction = &a_Function;
+            m_nActive   = m_nWorkers - 1;
+            ++m_nGeneration;
+        }
+        m_Wake.notify_all();
+
+        Run(0);
+
+        std::unique_lock<std::mutex> lock(m_Lock);
+        m_Done.wait(lock, [this]() {return m_nActive == 0;});
+        m_pFunction = nullptr;
+    }
+
+    void ThreadPool::WorkerMain(unsigned a_Worker)
+    {
+        size_t generation = 0;
+        for(;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_Lock);
+                m_Wake.wait(lock, [&]() {return m_Stop || (m_nGeneration != generation);});
+                if (m_Stop) {
+                    return;
+                }
+                generation = m_nGeneration;
+            }
+            Run(a_Worker);
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                --m_nActive;
+            }
+            m_Done.notify_one();
+        }
+    }
+
+    /**
+     * Work is never added while running, so once a worker finds nothing to pop or steal
+     * it's done and the rest of the indices are already being processed.
+     */
+    void ThreadPool::Run(unsigned a_Worker)
+    {
+        size_t index;
+        while(Pop(a_Worker, index) || Steal(a_Worker, index)) {
+            (*m_pFunction)(index, a_Worker);
+        }
+    }
+
+    bool ThreadPool::Pop(unsigned a_Worker, size_t & a_Index)
+    {
+        Range & range = m_Ranges[a_Worker];
+        std::lock_guard<std::mutex> lock(range.Lock);
+        if (range.Begin == range.End) {
+            return false;
+        }
+        a_Index = range.Begin++;
+        return true;
+    }
+
+    bool ThreadPool::Steal(unsigned a_Worker, size_t & a_Index)
+    {
+        for(unsigned i = 1; i < m_nWorkers; ++i) {
+            Range & victim = m_Ranges[(a_Worker + i) % m_nWorkers];
+            size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(victim.Lock);
+                size_t remaining = victim.End - victim.Begin;
+                if (remaining == 0) {
+                    continue;
+                }
+                /** take the back half, the victim keeps working from the front */
+                end         = victim.End;
+                begin       = end - (remaining + 1) / 2;
+                victim.End  = begin;
+            }
+            Range & own = m_Ranges[a_Worker];
+            std::lock_guard<std::mutex> lock(own.Lock);
+            own.Begin   = begin + 1;
+            own.End     = end;
+            a_Index     = begin;
+            return true;
+        }
+        return false;
+    }
+}
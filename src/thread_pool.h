@@ -0,0 +1,72 @@
+#ifndef _FLOW_THREAD_POOL_H_
+#define _FLOW_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flow
+{
+    /**
+     * \brief   A fixed set of worker threads that run index ranges with work stealing.
+     *
+     * Each worker starts with an even share of the indices and takes them one at a time
+     * from the front of its range. A worker that runs dry steals the back half of another
+     * worker's remaining range, so a few expensive items can't leave the other workers idle.
+     */
+    class ThreadPool
+    {
+    public:
+        typedef std::function<void (size_t a_Index, unsigned a_Worker)> Function;
+
+        /**
+         * \param   a_Threads   Number of workers including the calling thread, 0 uses one per hardware thread.
+         */
+        explicit ThreadPool(unsigned a_Threads = 0);
+        ~ThreadPool();
+
+        /**
+         * \brief   Calls a_Function for every index in [0, a_Count) and waits for all of them.
+         *
+         * The calling thread works as worker 0, a_Worker is in [0, Size()) and identifies the 
+         * thread so callers can keep per-worker state without locking.
+         */
+        void        ForEach(size_t a_Count, const Function & a_Function);
+        unsigned    Size() const        {return m_nWorkers;}
+
+    protected:
+        ThreadPool(const ThreadPool &);
+        ThreadPool & operator=(const ThreadPool &);
+
+        /** A worker's remaining indices, padded to keep the workers off each others cache lines */
+        struct alignas(64) Range {
+            std::mutex  Lock;
+            size_t      Begin;
+            size_t      End;
+        };
+
+        void        WorkerMain(unsigned a_Worker);
+        void        Run(unsigned a_Worker);
+        bool        Pop(unsigned a_Worker, size_t & a_Index);
+        bool        Steal(unsigned a_Worker, size_t & a_Index);
+
+        unsigned                    m_nWorkers;
+        std::unique_ptr<Range[]>    m_Ranges;
+        std::vector<std::thread>    m_Threads;
+
+        std::mutex                  m_ForEachLock;  /**< One ForEach at a time */
+        std::mutex                  m_Lock;
+        std::condition_variable     m_Wake;
+        std::condition_variable     m_Done;
+        const Function *            m_pFunction;
+        size_t                      m_nGeneration;
+        unsigned                    m_nActive;
+        bool                        m_Stop;
+    };
+}
+
+#endif
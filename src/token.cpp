@@ -1,297 +1,417 @@
-#include "token.h"
-#include <sstream>
-#include <string>
-#include <cctype>
-
-using namespace std;
-
-#define stringify( name ) #name
-
-namespace flow
-{
-    using std::string;
-
-    /** Single characters tokens */
-    static struct {
-        char        c;
-        Symbol_t    sym;
-    } SingleTokens[] = {
-        {';', T_SEMICOLON}, 
-        {':', T_COLON}, 
-        {'.', T_DOT},
-        {'?', T_QUESTION},
-        {',', T_COMMA},
-        {'(', T_LEFT_PAREN}, 
-        {')', T_RIGHT_PAREN}, 
-        {'{', T_LEFT_CURLY_BRACKET}, 
-        {'}', T_RIGHT_CURLY_BRACKET},
-        {'[', T_LEFT_SQUARE_BRACKET}, 
-        {']', T_RIGHT_SQUARE_BRACKET},
-        {'+', T_ADD}, 
-        {'-', T_SUB}, 
-        {'*', T_MUL}, 
-        {'/', T_DIV}
-    };
-
-    /** Keywords */
-    static struct {
-        const char *    keyword;
-        Symbol_t        sym;
-    } Keywords[] = {
-        {"in", T_KEYWORD_IN}, 
-        {"out", T_KEYWORD_OUT},
-        {"event", T_KEYWORD_EVENT},
-        {"node", T_KEYWORD_NODE},
-        {"query", T_KEYWORD_QUERY},
-        {"float", T_TYPE_FLOAT},
-        {"bool", T_TYPE_BOOL},
-        {"true", T_KEYWORD_TRUE},
-        {"false", T_KEYWORD_FALSE}
-    };
-
-    bool Tokenizer::GetChar( char & c ) 
-    {
-        if (!m_Stream.get(c)) {
-            return false;
-        }
-
-        /** Update the position */
-        switch(c) {
-        case '\n':      ++m_Position.Row; m_Position.Col = 0; break;
-        case '\t':      m_Position.Col += 4; break;
-        default:        ++m_Position.Col; break;
-        }
-
-        return true;
-    }
-
-    bool Tokenizer::Peek( char & c ) 
-    {
-        c = m_Stream.peek();
-        if (c == EOF) {
-            return false;
-        }
-        return true;
-    }
-
-    /**
-     * Peek at the next symbol without consuming it.
-     */
-    Symbol_t Tokenizer::Peek()
-    {
-        if (!m_HasPeeked) {
-            m_NextSym   = GetSym();
-            m_HasPeeked = true;
-        }
-        return m_NextSym;
-    }
-
-    Symbol_t Tokenizer::GetSym()
-    {
-        m_State = TOK_INITIAL;
-        if (m_HasPeeked) {
-            m_HasPeeked = false;
-            return m_NextSym;
-        }
-        char c;
-        string value;
-        if (!GetChar(c)) {
-            return T_EOF;   /** end-of-file */
-        }
-        for(;;) {
-            switch(m_State)
-            {
-            case TOK_INITIAL:    /** handle single character tokens */
-                if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
-                    if (!GetChar(c)) {
-                        return T_EOF;
-                    }
-                    continue;
-                }
-                for(size_t i = 0; i < sizeof(SingleTokens)/sizeof(SingleTokens[0]); i++) {
-                    if (SingleTokens[i].c == c) {
-                        return SingleTokens[i].sym;
-                    }
-                }
-                if (c == '=') {
-                    /** either assign or equal */
-                    return (Peek(c) ? ((c == '=') ? (GetChar(c), T_EQUAL) : T_ASSIGN) : T_ASSIGN);
-                } else if (c == '<') {
-                    /** either T_LESS or T_LEQ */
-                    return (Peek(c) ? ((c == '=') ? (GetChar(c), T_LEQ) : T_LESS) : T_LESS);
-                } else if(c == '>') {
-                    /** either T_GRT or T_GRT */
-                    return (Peek(c) ? ((c == '=') ? (GetChar(c), T_GEQ) : T_GRT) : T_GRT);
-                } else if (isdigit(c)) {
-                    m_State = TOK_NUMERIC;
-                    value += c;
-                    continue;
-                } else if(std::isalpha(c)) {
-                    m_State = TOK_IDENT;
-                    value += c;
-                    continue;
-                } else {
-                    /** error */
-                }
-            case TOK_IDENT:             
-                while(Peek(c) && (std::isalnum(c) || (c == '_'))) 
-                {
-                    GetChar(c);
-                    value += c;
-                }
-                /** match it against known keywords */
-                for(size_t i = 0; i < sizeof(Keywords)/sizeof(Keywords[0]); i++) {
-                    if (value == Keywords[i].keyword) {
-                        return Keywords[i].sym;
-                    }
-                }
-                u.m_SymbolIndex = m_SymbolTable.Insert(value.c_str());
-                return T_IDENT;
-            case TOK_NUMERIC:   /** integer or floating point numbr */
-                while(Peek(c)) {
-                    if (std::isdigit(c)) {
-                        GetChar(c);
-                        value += c;
-                    } else if (c == '.') {
-                        GetChar(c);
-                        m_State = TOK_FLOAT;
-                        value += c;
-                        break;
-                    } else {
-                        break;  /** return T_INTEGER */
-                    }
-                }
-                if (m_State == TOK_NUMERIC) {
-                    std::stringstream ss;
-                    ss << value;
-                    if (!(ss >> u.m_IntValue)) {
-                        return T_FAILURE;
-                    }
-                    return T_INTEGER;
-                }
-                break;
-            case TOK_FLOAT:
-                while(Peek(c)) {
-                    if (std::isdigit(c)) {
-                        GetChar(c);
-                        value += c;
-                    } else if (c == 'f') {
-                        GetChar(c);
-                        break;
-                    } else {
-                        break;
-                    }
-                }
-                /** convert to float */
-                {
-                    std::stringstream ss;
-                    ss << value;
-                    if (!(ss >> u.m_RealValue)) {
-                        return T_FAILURE;
-                    }
-                    return T_REAL;
-                }
-                break;
-            }
-        }
-    }
-
-    /**
-     * Returns the string associated with the SymIndex, or null.
-     */
-    const char * SymbolTable::Retrive(SymbolTable::SymIndex index) const
-    {
-        return this->m_StringPool.GetPointer(index);
-    }
-
-    /**
-     * Inserts a string into the symboltable and returns the symindex for the string.
-     */
-    SymbolTable::SymIndex SymbolTable::Insert(const char * pStr, bool modify)
-    {
-        if (pStr==nullptr) {
-            return (SymbolTable::SymIndex) -1;
-        }
-
-        SymbolTable::Node * pCurrent = m_pRoot, ** dst = &m_pRoot;
-        while(pCurrent != nullptr) {
-            int res = strcmp(pStr, pCurrent->m_pStr);
-            if (res == 0) {
-                return pCurrent->m_nOffset;
-            } else if (res < 0) {  // check left subtree
-                if (pCurrent->m_pLeft == nullptr) {  // insert it here
-                    dst = &pCurrent->m_pLeft;
-                    break;
-                } else {
-                    pCurrent = pCurrent->m_pLeft;
-                }
-            } else { // check right subtree.
-                if (pCurrent->m_pRight == nullptr) {
-                    dst = &pCurrent->m_pRight;
-                    break;
-                } else {
-                    pCurrent = pCurrent->m_pRight;
-                }
-            }
-        }
-
-        if (!modify) {
-            return (SymbolTable::SymIndex) -1;
-        }
-
-        *dst = new (std::nothrow) SymbolTable::Node;
-        // insert the string into the string pool.
-        size_t offset = m_StringPool.Insert(pStr, strlen(pStr) + 1);
-        if (offset == ((size_t) -1)) {
-            return (SymbolTable::SymIndex) -1;
-        }
-        (*dst)->m_pStr     = m_StringPool.GetPointer(offset);
-        (*dst)->m_nOffset  = offset;
-        if (!(*dst)->m_pStr) {
-            return (SymbolTable::SymIndex) -1;
-        }
-        return offset;
-    }
-
-    const char * Tokenizer::GetTokenString(Symbol_t sym)
-    {
-        switch(sym) {
-        case T_IDENT:                   return stringify(T_IDENT);
-        case T_KEYWORD_IN:              return stringify(T_KEYWORD_IN);
-        case T_KEYWORD_OUT:             return stringify(T_KEYWORD_OUT);
-        case T_KEYWORD_NODE:            return stringify(T_KEYWORD_NODE);
-        case T_KEYWORD_QUERY:           return stringify(T_KEYWORD_QUERY);
-        case T_KEYWORD_EVENT:           return stringify(T_KEYWORD_EVENT);
-        case T_KEYWORD_TRUE:            return stringify(T_KEYWORD_TRUE);
-        case T_KEYWORD_FALSE:           return stringify(T_KEYWORD_FALSE);
-        case T_TYPE_FLOAT:              return stringify(T_TYPE_FLOAT);
-        case T_INTEGER:                 return stringify(T_TYPE_INTEGER);
-        case T_REAL:                    return stringify(T_REAL);
-        case T_ASSIGN:                  return stringify(T_ASSIGN);
-        case T_QUESTION:                return stringify(T_QUESTION);
-        case T_COMMA:                   return stringify(T_COMMA);
-        case T_SEMICOLON:               return stringify(T_SEMICOLON);
-        case T_COLON:                   return stringify(T_COLON);
-        case T_DOT:                     return stringify(T_DOT);
-        case T_LEFT_PAREN:              return stringify(T_LEFT_PAREN);
-        case T_RIGHT_PAREN:             return stringify(T_RIGHT_PAREN);
-        case T_LEFT_SQUARE_BRACKET:     return stringify(T_LEFT_SQUARE_BRACKET);
-        case T_RIGHT_SQUARE_BRACKET:    return stringify(T_RIGHT_SQUARE_BRACKET);
-        case T_LEFT_CURLY_BRACKET:      return stringify(T_LEFT_CURLY_BRACKET);
-        case T_RIGHT_CURLY_BRACKET:     return stringify(T_RIGHT_CURLY_BRACKET);
-        case T_ADD:                     return stringify(T_ADD);
-        case T_SUB:                     return stringify(T_SUB);
-        case T_MUL:                     return stringify(T_MUL);
-        case T_DIV:                     return stringify(T_DIV);
-        case T_EQUAL:                   return stringify(T_EQUAL);
-        case T_LESS:                    return stringify(T_ASSIGN);
-        case T_GRT:                     return stringify(T_GRT);
-        case T_LEQ:                     return stringify(T_LEQ);
-        case T_GEQ:                     return stringify(T_GEQ);
-        case T_FAILURE:                 return stringify(T_FAILURE);
-        case T_EOF:                     return stringify(T_EOF);
-        default:                        return 0;
-        }
-    }
-
-} // namespace flow
+#include "token.h"
+#include "scan.h"
+#include "token_tables.h"
+#include "token_buffer.h"
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <string>
+#include <new>
+
+using namespace std;
+
+#define stringify( name ) #name
+
+namespace flow
+{
+    using std::string;
+
+    Tokenizer::Tokenizer(std::istream & is, flow::SymbolTable & a_SymbolTable) : m_HasPeeked(false), m_SymbolTable(a_SymbolTable)
+    {
+        m_Buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+        m_pBegin    = m_Buffer.data();
+        m_pCur      = m_pBegin;
+        m_pEnd      = m_pBegin + m_Buffer.size();
+        m_pToken    = m_pBegin;
+        m_Lines.SetSource(m_pBegin, m_pEnd);
+    }
+
+    /**
+     * Peek at the next symbol without consuming it.
+     */
+    Symbol_t Tokenizer::Peek()
+    {
+        if (!m_HasPeeked) {
+            m_NextSym   = Scan();
+            m_HasPeeked = true;
+        }
+        return m_NextSym;
+    }
+
+    Symbol_t Tokenizer::GetSym()
+    {
+        if (m_HasPeeked) {
+            m_HasPeeked = false;
+            return m_NextSym;
+        }
+        return Scan();
+    }
+
+    /**
+     * Scans the rest of the source into a token buffer, terminated by T_EOF.
+     */
+    bool Tokenizer::Lex(TokenBuffer & a_Buffer)
+    {
+        a_Buffer.Clear();
+        if (static_cast<size_t>(m_pEnd - m_pBegin) > 0xffffffffu) {
+            return false;
+        }
+        a_Buffer.Source     = m_pBegin;
+        a_Buffer.SourceSize = m_pEnd - m_pBegin;
+        /** a rough guess of one symbol per 8 bytes of source, avoids most of the regrowth */
+        size_t estimate = a_Buffer.SourceSize / 8 + 1;
+        if (a_Buffer.Symbols.capacity() < estimate) {
+            a_Buffer.Symbols.reserve(estimate);
+            a_Buffer.Offsets.reserve(estimate);
+            a_Buffer.Payloads.reserve(estimate);
+        }
+
+        for(;;) {
+            Symbol_t sym = GetSym();
+            uint32_t payload = 0;
+            switch(sym) {
+            case T_IDENT:   payload = u.m_SymbolIndex; break;
+            case T_INTEGER: payload = static_cast<uint32_t>(u.m_IntValue); break;
+            case T_REAL:    memcpy(&payload, &u.m_RealValue, sizeof(payload)); break;
+            default:        break;
+            }
+            a_Buffer.Symbols.push_back(static_cast<uint8_t>(sym));
+            a_Buffer.Offsets.push_back(static_cast<uint32_t>(m_pToken - m_pBegin));
+            a_Buffer.Payloads.push_back(payload);
+            if (sym == T_EOF) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Scans the next symbol from the source buffer.
+     */
+    Symbol_t Tokenizer::Scan()
+    {
+        const char * p = m_pCur, * end = m_pEnd;
+        if ((p != end) && (CharTable.Classes[static_cast<unsigned char>(*p)] & CC_SPACE)) {
+            p = ScanWhitespace(p + 1, end);
+        }
+        m_pToken = p;
+        if (p == end) {
+            m_pCur = p;
+            return T_EOF;   /** end-of-file */
+        }
+
+        const char * start = p;
+        char c = *p++;
+        unsigned char cls = CharTable.Classes[static_cast<unsigned char>(c)];
+        if (cls & CC_SINGLE) {
+            m_pCur = p;
+            return CharTable.Single[static_cast<unsigned char>(c)];
+        }
+
+        Symbol_t sym = T_FAILURE;
+        if (c == '=') {
+            /** either assign or equal */
+            sym = ((p != end) && (*p == '=')) ? (++p, T_EQUAL) : T_ASSIGN;
+        } else if (c == '<') {
+            /** either T_LESS or T_LEQ */
+            sym = ((p != end) && (*p == '=')) ? (++p, T_LEQ) : T_LESS;
+        } else if(c == '>') {
+            /** either T_GRT or T_GEQ */
+            sym = ((p != end) && (*p == '=')) ? (++p, T_GEQ) : T_GRT;
+        } else if (cls & CC_DIGIT) {
+            /** integer or floating point number, converted in place from the source */
+            bool real = false;
+            p = ScanDigits(p, end);
+            if ((p != end) && (*p == '.')) {
+                real = true;
+                p = ScanDigits(p + 1, end);
+            }
+            if ((p != end) && (*p == 'e' || *p == 'E')) {
+                /** only an exponent if digits follow, otherwise the 'e' starts the next token */
+                const char * exponent = p + 1;
+                if ((exponent != end) && (*exponent == '+' || *exponent == '-')) {
+                    ++exponent;
+                }
+                if ((exponent != end) && (CharTable.Classes[static_cast<unsigned char>(*exponent)] & CC_DIGIT)) {
+                    real = true;
+                    p = ScanDigits(exponent, end);
+                }
+            }
+            std::from_chars_result res;
+            if (real) {
+                res = std::from_chars(start, p, u.m_RealValue);
+                sym = T_REAL;
+                if ((p != end) && (*p == 'f')) {
+                    ++p;
+                }
+            } else {
+                res = std::from_chars(start, p, u.m_IntValue);
+                sym = T_INTEGER;
+            }
+            /** out of range reports overflow, and underflow to zero for reals */
+            if (res.ec != std::errc()) {
+                sym = T_FAILURE;
+            }
+        } else if(cls & CC_IDENT_START) {
+            p = ScanIdentifier(p, end);
+            m_Identifier = std::string_view(start, p - start);
+            /** match it against known keywords */
+            sym = MatchKeyword(start, p - start);
+            if (sym == T_IDENT) {
+                u.m_SymbolIndex = m_SymbolTable.Insert(start, static_cast<size_t>(p - start));
+                /** the symbol table is full or out of memory */
+                if (u.m_SymbolIndex == SymbolTable::InvalidIndex) {
+                    sym = T_FAILURE;
+                }
+            }
+        }
+        m_pCur = p;
+        return sym;
+    }
+
+    void LineIndex::SetSource(const char * a_Begin, const char * a_End)
+    {
+        m_pBegin    = a_Begin;
+        m_pEnd      = a_End;
+        m_IsBuilt   = false;
+        m_Newlines.clear();
+    }
+
+    void LineIndex::Build()
+    {
+        m_Newlines.reserve(CountNewlines(m_pBegin, m_pEnd));
+        for(const char * p = m_pBegin; p != m_pEnd; ++p) {
+            p = static_cast<const char *>(memchr(p, '\n', m_pEnd - p));
+            if (!p) {
+                break;
+            }
+            m_Newlines.push_back(p - m_pBegin);
+        }
+        m_IsBuilt = true;
+    }
+
+    PositionInfo LineIndex::Position(size_t a_Offset)
+    {
+        if (!m_IsBuilt) {
+            Build();
+        }
+        PositionInfo pos;
+        /** the row is the number of newlines before the offset */
+        std::vector<size_t>::const_iterator it = std::lower_bound(m_Newlines.begin(), m_Newlines.end(), a_Offset);
+        pos.Row = it - m_Newlines.begin();
+        size_t lineStart = (pos.Row == 0) ? 0 : (m_Newlines[pos.Row - 1] + 1);
+        for(size_t i = lineStart; i < a_Offset; ++i) {
+            pos.Col += (m_pBegin[i] == '\t') ? 4 : 1;
+        }
+        return pos;
+    }
+
+    /**
+     * Returns the string associated with the SymIndex, or null.
+     */
+    const char * SymbolTable::Retrive(SymbolTable::SymIndex index) const
+    {
+        if (index >= m_Entries.size()) {
+            return nullptr;
+        }
+        return m_Entries[index].m_pStr;
+    }
+
+    /**
+     * Returns the length of the string associated with the SymIndex.
+     */
+    size_t SymbolTable::Length(SymbolTable::SymIndex index) const
+    {
+        return (index < m_Entries.size()) ? m_Entries[index].m_nLength : 0;
+    }
+
+    /**
+     * FNV-1a with a final avalanche, so the low bits can be used directly as a slot index.
+     */
+    uint32_t SymbolTable::Hash(const char * pStr, size_t length)
+    {
+        uint32_t h = 2166136261u;
+        for(size_t i = 0; i < length; ++i) {
+            h = (h ^ static_cast<unsigned char>(pStr[i])) * 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    /**
+     * Finds the string, or the empty slot where it should be inserted.
+     */
+    SymbolTable::SymIndex SymbolTable::Probe(const char * pStr, size_t length, uint32_t hash, size_t * pSlot) const
+    {
+        size_t slot = hash & m_nSlotMask;
+        for(;;) {
+            const Slot & s = m_Slots[slot];
+            if ((s.m_nIndex == InvalidIndex) || (s.m_nIndex < m_nBase)) {
+                *pSlot = slot;
+                return InvalidIndex;
+            }
+            if (s.m_nHash == hash) {
+                const Entry & e = m_Entries[s.m_nIndex - m_nBase];
+                if ((e.m_nLength == length) && (memcmp(e.m_pStr, pStr, length) == 0)) {
+                    *pSlot = slot;
+                    return s.m_nIndex - m_nBase;
+                }
+            }
+            slot = (slot + 1) & m_nSlotMask;
+        }
+    }
+
+    /**
+     * Doubles the number of slots, rehashing from the cached hashes.
+     */
+    bool SymbolTable::Grow()
+    {
+        size_t count = m_Slots.empty() ? 64 : m_Slots.size() * 2;
+        std::vector<Slot> slots;
+        try {
+            slots.resize(count, Slot{0, InvalidIndex});
+        } catch(const std::bad_alloc &) {
+            return false;
+        }
+        m_nSlotMask = count - 1;
+        for(size_t i = 0; i < m_Entries.size(); ++i) {
+            size_t slot = m_Entries[i].m_nHash & m_nSlotMask;
+            while(slots[slot].m_nIndex != InvalidIndex) {
+                slot = (slot + 1) & m_nSlotMask;
+            }
+            slots[slot].m_nHash  = m_Entries[i].m_nHash;
+            slots[slot].m_nIndex = m_nBase + static_cast<uint32_t>(i);
+        }
+        m_Slots.swap(slots);
+        return true;
+    }
+
+    void SymbolTable::Clear(bool a_KeepMemory)
+    {
+        /** rebasing long before the stamps wrap leaves room for the entries of one generation */
+        static const uint32_t MaxBase = 0x80000000u;
+
+        if (!a_KeepMemory) {
+            std::vector<Entry>().swap(m_Entries);
+            std::vector<Slot>().swap(m_Slots);
+            m_nSlotMask = 0;
+            m_nBase     = 0;
+            m_StringPool.Release();
+            return;
+        }
+        m_nBase += static_cast<uint32_t>(m_Entries.size());
+        if (m_nBase >= MaxBase) {
+            std::fill(m_Slots.begin(), m_Slots.end(), Slot{0, InvalidIndex});
+            m_nBase = 0;
+        }
+        m_Entries.clear();
+        m_StringPool.Reset();
+    }
+
+    size_t SymbolTable::MemoryUsage() const
+    {
+        return m_Entries.capacity() * sizeof(Entry) + m_Slots.capacity() * sizeof(Slot) + m_StringPool.Capacity();
+    }
+
+    SymbolTable::SymIndex SymbolTable::Find(const char * pStr, size_t length) const
+    {
+        if (!pStr || m_Slots.empty()) {
+            return InvalidIndex;
+        }
+        size_t slot;
+        return Probe(pStr, length, Hash(pStr, length), &slot);
+    }
+
+    /**
+     * Inserts a string into the symboltable and returns the symindex for the string.
+     */
+    SymbolTable::SymIndex SymbolTable::Insert(const char * pStr, bool modify)
+    {
+        if (pStr==nullptr) {
+            return InvalidIndex;
+        }
+        return Insert(pStr, strlen(pStr), modify);
+    }
+
+    /**
+     * Inserts a string that isn't null terminated into the symboltable.
+     */
+    SymbolTable::SymIndex SymbolTable::Insert(const char * pStr, size_t length, bool modify)
+    {
+        if (!modify) {
+            return Find(pStr, length);
+        }
+        if ((pStr == nullptr) || (length >= 0xffffffffu) || (m_nBase + m_Entries.size() >= InvalidIndex - 1)) {
+            return InvalidIndex;
+        }
+        /** keep the load factor at or below one half */
+        if (((m_Entries.size() + 1) * 2 > m_Slots.size()) && !Grow()) {
+            return InvalidIndex;
+        }
+
+        uint32_t hash = Hash(pStr, length);
+        size_t slot;
+        SymIndex index = Probe(pStr, length, hash, &slot);
+        if (index != InvalidIndex) {
+            return index;
+        }
+
+        // insert the string into the string pool, followed by the null terminator.
+        const char * pCopy = m_StringPool.InsertString(pStr, length);
+        if (!pCopy) {
+            return InvalidIndex;
+        }
+
+        index = static_cast<SymIndex>(m_Entries.size());
+        m_Entries.push_back(Entry{pCopy, static_cast<uint32_t>(length), hash});
+        m_Slots[slot].m_nHash   = hash;
+        m_Slots[slot].m_nIndex  = m_nBase + index;
+        return index;
+    }
+
+    const char * Tokenizer::GetTokenString(Symbol_t sym)
+    {
+        switch(sym) {
+        case T_IDENT:                   return stringify(T_IDENT);
+        case T_KEYWORD_IN:              return stringify(T_KEYWORD_IN);
+        case T_KEYWORD_OUT:             return stringify(T_KEYWORD_OUT);
+        case T_KEYWORD_NODE:            return stringify(T_KEYWORD_NODE);
+        case T_KEYWORD_QUERY:           return stringify(T_KEYWORD_QUERY);
+        case T_KEYWORD_EVENT:           return stringify(T_KEYWORD_EVENT);
+        case T_KEYWORD_TRUE:            return stringify(T_KEYWORD_TRUE);
+        case T_KEYWORD_FALSE:           return stringify(T_KEYWORD_FALSE);
+        case T_TYPE_FLOAT:              return stringify(T_TYPE_FLOAT);
+        case T_INTEGER:                 return stringify(T_TYPE_INTEGER);
+        case T_REAL:                    return stringify(T_REAL);
+        case T_ASSIGN:                  return stringify(T_ASSIGN);
+        case T_QUESTION:                return stringify(T_QUESTION);
+        case T_COMMA:                   return stringify(T_COMMA);
+        case T_SEMICOLON:               return stringify(T_SEMICOLON);
+        case T_COLON:                   return stringify(T_COLON);
+        case T_DOT:                     return stringify(T_DOT);
+        case T_LEFT_PAREN:              return stringify(T_LEFT_PAREN);
+        case T_RIGHT_PAREN:             return stringify(T_RIGHT_PAREN);
+        case T_LEFT_SQUARE_BRACKET:     return stringify(T_LEFT_SQUARE_BRACKET);
+        case T_RIGHT_SQUARE_BRACKET:    return stringify(T_RIGHT_SQUARE_BRACKET);
+        case T_LEFT_CURLY_BRACKET:      return stringify(T_LEFT_CURLY_BRACKET);
+        case T_RIGHT_CURLY_BRACKET:     return stringify(T_RIGHT_CURLY_BRACKET);
+        case T_ADD:                     return stringify(T_ADD);
+        case T_SUB:                     return stringify(T_SUB);
+        case T_MUL:                     return stringify(T_MUL);
+        case T_DIV:                     return stringify(T_DIV);
+        case T_EQUAL:                   return stringify(T_EQUAL);
+        case T_LESS:                    return stringify(T_ASSIGN);
+        case T_GRT:                     return stringify(T_GRT);
+        case T_LEQ:                     return stringify(T_LEQ);
+        case T_GEQ:                     return stringify(T_GEQ);
+        case T_FAILURE:                 return stringify(T_FAILURE);
+        case T_EOF:                     return stringify(T_EOF);
+        default:                        return 0;
+        }
+    }
+
+} // namespace flow
@@ -1,142 +1,235 @@
-#ifndef _FLOW_TOKEN_H_
-#define _FLOW_TOKEN_H_
-
-#include <iostream>
-#include "pool.h"
-
-namespace flow
-{
-    typedef enum {
-        T_IDENT,
-        /** keywords */
-        T_KEYWORD_IN,
-        T_KEYWORD_OUT,
-        T_KEYWORD_NODE,
-        T_KEYWORD_QUERY,
-        T_KEYWORD_EVENT,
-        T_KEYWORD_TRUE,
-        T_KEYWORD_FALSE,
-        /** types */
-        T_TYPE_FLOAT,
-        T_TYPE_BOOL,
-        T_INTEGER,
-        T_REAL,
-        T_ASSIGN,
-        /** single character tokens */
-        T_QUESTION,
-        T_COMMA,
-        T_SEMICOLON,
-        T_COLON,
-        T_DOT,
-        T_LEFT_PAREN,               /* ( */
-        T_RIGHT_PAREN,              /* ) */
-        T_LEFT_SQUARE_BRACKET,      /* [ */
-        T_RIGHT_SQUARE_BRACKET,     /* ] */
-        T_LEFT_CURLY_BRACKET,       /* { */
-        T_RIGHT_CURLY_BRACKET,       /* } */
-        /** operators */
-        T_ADD,
-        T_SUB,
-        T_MUL,
-        T_DIV,
-        T_EQUAL,
-        T_LESS,
-        T_GRT,
-        T_LEQ,
-        T_GEQ,
-        /** Parse error */
-        T_FAILURE,
-        /** eof */
-        T_EOF
-    } Symbol_t;
-
-    class SymbolTable
-    {
-    public:
-        SymbolTable() : m_pRoot(nullptr)
-        {
-        }
-
-        typedef size_t SymIndex;
-
-        SymIndex Insert(const char *, bool modify = true);
-        const char * Retrive(SymIndex index)    const;
-
-    protected:
-        struct Node {
-            Node() : m_pStr(nullptr), m_nOffset(0), m_pLeft(nullptr), m_pRight(nullptr)
-            {
-            }
-            const char * m_pStr;
-            size_t       m_nOffset;
-
-            Node * m_pLeft;
-            Node * m_pRight;
-        } * m_pRoot;
-
-        Pool<char, 64>  m_StringPool;
-    };
-
-    struct PositionInfo
-    {
-        PositionInfo() : Row(0), Col(0)
-        {
-        }
-
-        size_t      Row;
-        size_t      Col;
-    };
-
-    class Tokenizer
-    {
-    public:
-        Tokenizer(std::istream & is) : m_Stream(is), m_State(TOK_INITIAL), m_HasPeeked(false)
-        {
-        }
-
-        Symbol_t    GetSym();
-        Symbol_t    Peek();
-
-        SymbolTable::SymIndex       SymIndex() const            {return u.m_SymbolIndex;}
-        float                       RealValue() const           {return u.m_RealValue;}
-        int                         IntValue() const            {return u.m_IntValue;}
-        flow::SymbolTable &         SymbolTable()               {return m_SymbolTable;}
-        const PositionInfo &        Position() const            {return m_Position;}
-        
-        const char *                Lookup(SymbolTable::SymIndex sym) const  
-        {
-            return m_SymbolTable.Retrive(sym);
-        }
-
-        static const char *         GetTokenString(Symbol_t);
-
-    protected:
-        Tokenizer(const Tokenizer &);
-        Tokenizer & operator=(const Tokenizer &);
-
-        enum {
-            TOK_INITIAL,
-            TOK_NUMERIC,
-            TOK_IDENT,
-            TOK_FLOAT
-        } m_State;
-
-        bool Peek(char &);
-        bool GetChar(char &);
-
-        Symbol_t        m_NextSym;
-        bool            m_HasPeeked;
-
-        std::istream &                  m_Stream;
-        flow::SymbolTable               m_SymbolTable;
-        PositionInfo                    m_Position;
-
-        union {
-            SymbolTable::SymIndex           m_SymbolIndex;
-            float                           m_RealValue;
-            int                             m_IntValue;
-        } u;
-    };
-} // namespace flow
-
+#ifndef _FLOW_TOKEN_H_
+#define _FLOW_TOKEN_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "pool.h"
+
+namespace flow
+{
+    typedef enum {
+        T_IDENT,
+        /** keywords */
+        T_KEYWORD_IN,
+        T_KEYWORD_OUT,
+        T_KEYWORD_NODE,
+        T_KEYWORD_QUERY,
+        T_KEYWORD_EVENT,
+        T_KEYWORD_TRUE,
+        T_KEYWORD_FALSE,
+        /** types */
+        T_TYPE_FLOAT,
+        T_TYPE_BOOL,
+        T_INTEGER,
+        T_REAL,
+        T_ASSIGN,
+        /** single character tokens */
+        T_QUESTION,
+        T_COMMA,
+        T_SEMICOLON,
+        T_COLON,
+        T_DOT,
+        T_LEFT_PAREN,               /* ( */
+        T_RIGHT_PAREN,              /* ) */
+        T_LEFT_SQUARE_BRACKET,      /* [ */
+        T_RIGHT_SQUARE_BRACKET,     /* ] */
+        T_LEFT_CURLY_BRACKET,       /* { */
+        T_RIGHT_CURLY_BRACKET,       /* } */
+        /** operators */
+        T_ADD,
+        T_SUB,
+        T_MUL,
+        T_DIV,
+        T_EQUAL,
+        T_LESS,
+        T_GRT,
+        T_LEQ,
+        T_GEQ,
+        /** Parse error */
+        T_FAILURE,
+        /** eof */
+        T_EOF
+    } Symbol_t;
+
+    /**
+     * \brief  Interns strings and hands out dense 32-bit symbol indices.
+     *
+     * Open addressing with linear probing, each slot caches the hash of its entry so
+     * that probing and rehashing never touch the strings themselves.
+     */
+    class SymbolTable
+    {
+    public:
+        SymbolTable() : m_nSlotMask(0), m_nBase(0)
+        {
+        }
+
+        typedef uint32_t SymIndex;
+
+        static const SymIndex InvalidIndex = (SymIndex) -1;
+
+        SymIndex Insert(const char *, bool modify = true);
+        SymIndex Insert(const char *, size_t, bool modify = true);
+        /** Lookup only, never allocates. Returns InvalidIndex if the string hasn't been interned */
+        SymIndex Find(const char *, size_t) const;
+        const char * Retrive(SymIndex index)    const;
+        size_t       Length(SymIndex index)     const;
+        /** Number of interned strings, symbol indices are in the range [0, Size()) */
+        size_t       Size() const               {return m_Entries.size();}
+        /** 
+         * Removes every string, all previous symbol indices become invalid. Keeping the memory
+         * makes this O(1), the slots are invalidated by moving the base instead of being cleared.
+         */
+        void         Clear(bool a_KeepMemory = true);
+        /** Bytes held by the table, including memory kept by Clear() */
+        size_t       MemoryUsage() const;
+
+        static uint32_t Hash(const char *, size_t);
+
+    protected:
+        struct Entry {
+            const char* m_pStr;     /**< Null terminated copy in the string pool */
+            uint32_t    m_nLength;
+            uint32_t    m_nHash;
+        };
+
+        struct Slot {
+            uint32_t    m_nHash;
+            uint32_t    m_nIndex;   /**< m_nBase + SymIndex, empty if below m_nBase or InvalidIndex */
+        };
+
+        SymIndex    Probe(const char *, size_t, uint32_t, size_t *) const;
+        bool        Grow();
+
+        std::vector<Entry>  m_Entries;      /**< Indexed by SymIndex */
+        std::vector<Slot>   m_Slots;
+        size_t              m_nSlotMask;
+        uint32_t            m_nBase;        /**< Slots written before the last Clear() are below this */
+        Arena               m_StringPool;
+    };
+
+    struct TokenBuffer;
+
+    struct PositionInfo
+    {
+        PositionInfo() : Row(0), Col(0)
+        {
+        }
+
+        size_t      Row;
+        size_t      Col;
+    };
+
+    /**
+     * \brief  Maps byte offsets in a source buffer to rows and columns.
+     *
+     * Positions are only needed when reporting errors, so the tokenizers just track byte 
+     * offsets and the newline offsets are collected here the first time a position is asked for.
+     */
+    class LineIndex
+    {
+    public:
+        LineIndex() : m_pBegin(nullptr), m_pEnd(nullptr), m_IsBuilt(false)
+        {
+        }
+
+        /** Sets the source, the index itself is built lazily */
+        void            SetSource(const char * a_Begin, const char * a_End);
+        /** The row and column after consuming a_Offset bytes, tabs count as 4 columns */
+        PositionInfo    Position(size_t a_Offset);
+
+    protected:
+        void            Build();
+
+        const char *            m_pBegin;
+        const char *            m_pEnd;
+        std::vector<size_t>     m_Newlines;     /**< Offsets of every newline in the source */
+        bool                    m_IsBuilt;
+    };
+
+    /**
+     * \brief  Splits a contiguous source buffer into symbols.
+     *
+     * The tokenizer walks the buffer with plain pointer bumps and never copies the 
+     * source, identifiers are reported as slices into the buffer which must outlive
+     * the tokenizer.
+     */
+    class Tokenizer
+    {
+    public:
+        Tokenizer(const char * a_Begin, const char * a_End, flow::SymbolTable & a_SymbolTable) : 
+            m_HasPeeked(false), m_pBegin(a_Begin), m_pCur(a_Begin), m_pEnd(a_End), m_pToken(a_Begin), m_SymbolTable(a_SymbolTable)
+        {
+            m_Lines.SetSource(m_pBegin, m_pEnd);
+        }
+
+        Tokenizer(std::string_view a_Source, flow::SymbolTable & a_SymbolTable) : 
+            m_HasPeeked(false), m_pBegin(a_Source.data()), m_pCur(a_Source.data()), m_pEnd(a_Source.data() + a_Source.size()), 
+            m_pToken(a_Source.data()), m_SymbolTable(a_SymbolTable)
+        {
+            m_Lines.SetSource(m_pBegin, m_pEnd);
+        }
+
+        /** Reads the whole stream into an internal buffer and tokenizes that */
+        Tokenizer(std::istream & is, flow::SymbolTable & a_SymbolTable);
+
+        Symbol_t    GetSym();
+        Symbol_t    Peek();
+        /**
+         * \brief   Scans the rest of the source into a token buffer.
+         * \return  false if the source is too large for 32-bit offsets.
+         */
+        bool        Lex(TokenBuffer &);
+        /** Moves the read position, discarding any peeked symbol */
+        void        Seek(size_t a_Offset)       {m_pCur = m_pBegin + a_Offset; m_HasPeeked = false;}
+
+        flow::SymbolTable::SymIndex SymIndex() const            {return u.m_SymbolIndex;}
+        float                       RealValue() const           {return u.m_RealValue;}
+        int                         IntValue() const            {return u.m_IntValue;}
+        flow::SymbolTable &         SymbolTable()               {return m_SymbolTable;}
+        /** The position after the last scanned symbol, computed on demand */
+        PositionInfo                Position()                  {return m_Lines.Position(m_pCur - m_pBegin);}
+        /** Byte offset where the last scanned symbol starts */
+        size_t                      TokenOffset() const         {return m_pToken - m_pBegin;}
+        /** Byte offset after the last scanned symbol */
+        size_t                      Offset() const              {return m_pCur - m_pBegin;}
+        /** The source text of the last identifier or keyword, only valid while the source buffer is */
+        std::string_view            Identifier() const          {return m_Identifier;}
+        
+        const char *                Lookup(flow::SymbolTable::SymIndex sym) const  
+        {
+            return m_SymbolTable.Retrive(sym);
+        }
+
+        static const char *         GetTokenString(Symbol_t);
+
+    protected:
+        Tokenizer(const Tokenizer &);
+        Tokenizer & operator=(const Tokenizer &);
+
+        Symbol_t        Scan();
+
+        Symbol_t        m_NextSym;
+        bool            m_HasPeeked;
+
+        std::string                     m_Buffer;       /**< Only used when constructed from a stream */
+        const char *                    m_pBegin;
+        const char *                    m_pCur;
+        const char *                    m_pEnd;
+        const char *                    m_pToken;       /**< Start of the last scanned symbol */
+        std::string_view                m_Identifier;
+        flow::SymbolTable &             m_SymbolTable;  /**< Identifiers are interned here, usually owned by the parser */
+        LineIndex                       m_Lines;
+
+        union {
+            flow::SymbolTable::SymIndex     m_SymbolIndex;
+            float                           m_RealValue;
+            int                             m_IntValue;
+        } u;
+    };
+} // namespace flow
+
 #endif
\ No newline at end of file
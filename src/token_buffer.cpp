@@ -0,0 +1,26 @@
+#include "token_buffer.h"
+
+namespace flow
+{
+    TokenStream::TokenStream(const TokenBuffer & a_Buffer, flow::SymbolTable & a_SymbolTable) : 
+        m_Buffer(a_Buffer), m_SymbolTable(a_SymbolTable), m_nPos(0), m_nCurrent(0), m_nTouched(0), 
+        m_nLast(a_Buffer.Size() ? a_Buffer.Size() - 1 : 0)
+    {
+        m_Lines.SetSource(a_Buffer.Source, a_Buffer.Source + a_Buffer.SourceSize);
+    }
+
+    /**
+     * Only the start of each token is stored, so the end of the furthest token is 
+     * found by scanning that single token again. This only happens on the error path.
+     */
+    PositionInfo TokenStream::Position()
+    {
+        if (m_nTouched == 0) {
+            return m_Lines.Position(0);
+        }
+        flow::Tokenizer tokenizer(m_Buffer.Source, m_Buffer.Source + m_Buffer.SourceSize, m_SymbolTable);
+        tokenizer.Seek(m_Buffer.Offsets[m_nTouched - 1]);
+        tokenizer.GetSym();
+        return m_Lines.Position(tokenizer.Offset());
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef _FLOW_TOKEN_BUFFER_H_
+#define _FLOW_TOKEN_BUFFER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "token.h"
+
+namespace flow
+{
+    /**
+     * \brief   The symbols of a whole document in struct-of-arrays form.
+     *
+     * Produced by a single lexing pass over the source, the last symbol is always T_EOF. 
+     * Payloads refer to the symbol table that was used when lexing, and the source buffer
+     * must outlive the token buffer since error positions are resolved against it.
+     */
+    struct TokenBuffer
+    {
+        TokenBuffer() : Source(nullptr), SourceSize(0)
+        {
+        }
+
+        std::vector<uint8_t>    Symbols;    /**< Symbol_t of each token */
+        std::vector<uint32_t>   Offsets;    /**< Byte offset where each token starts */
+        std::vector<uint32_t>   Payloads;   /**< SymIndex for T_IDENT, the value for T_INTEGER and the float bits for T_REAL */
+
+        const char *            Source;
+        size_t                  SourceSize;
+
+        size_t  Size() const    {return Symbols.size();}
+        /** Bytes held by the buffer, including capacity kept by Clear() */
+        size_t  MemoryUsage() const
+        {
+            return Symbols.capacity() * sizeof(uint8_t) + (Offsets.capacity() + Payloads.capacity()) * sizeof(uint32_t);
+        }
+
+        /** Empties the buffer but keeps the capacity for the next document */
+        void Clear()
+        {
+            Symbols.clear();
+            Offsets.clear();
+            Payloads.clear();
+            Source      = nullptr;
+            SourceSize  = 0;
+        }
+    };
+
+    /**
+     * \brief   Reads symbols from a TokenBuffer with the same interface as the Tokenizer,
+     *          plus arbitrary lookahead.
+     */
+    class TokenStream
+    {
+    public:
+        TokenStream(const TokenBuffer & a_Buffer, flow::SymbolTable & a_SymbolTable);
+
+        Symbol_t GetSym()
+        {
+            size_t index = (m_nPos < m_nLast) ? m_nPos++ : m_nLast;
+            m_nCurrent  = index;
+            m_nTouched  = (index >= m_nTouched) ? (index + 1) : m_nTouched;
+            return static_cast<Symbol_t>(m_Buffer.Symbols[index]);
+        }
+
+        /** Peeks at the symbol a_Ahead positions after the next one, past the end it's T_EOF */
+        Symbol_t Peek(size_t a_Ahead = 0)
+        {
+            size_t index = m_nPos + a_Ahead;
+            index = (index < m_nLast) ? index : m_nLast;
+            m_nTouched  = (index >= m_nTouched) ? (index + 1) : m_nTouched;
+            return static_cast<Symbol_t>(m_Buffer.Symbols[index]);
+        }
+
+        /** Payloads of the last symbol returned by GetSym */
+        flow::SymbolTable::SymIndex SymIndex() const    {return m_Buffer.Payloads[m_nCurrent];}
+        int                         IntValue() const    {return static_cast<int>(m_Buffer.Payloads[m_nCurrent]);}
+        float                       RealValue() const
+        {
+            float value;
+            memcpy(&value, &m_Buffer.Payloads[m_nCurrent], sizeof(value));
+            return value;
+        }
+
+        /** Byte offset where the last symbol returned by GetSym starts */
+        size_t                      TokenOffset() const {return m_Buffer.Offsets[m_nCurrent];}
+        /** Byte offset where the next symbol starts */
+        size_t                      NextOffset() const  {return m_Buffer.Offsets[(m_nPos < m_nLast) ? m_nPos : m_nLast];}
+        /** The position after the furthest symbol read or peeked so far, the same as the Tokenizer reports */
+        PositionInfo                Position();
+
+    protected:
+        TokenStream(const TokenStream &);
+        TokenStream & operator=(const TokenStream &);
+
+        const TokenBuffer &     m_Buffer;
+        flow::SymbolTable &     m_SymbolTable;
+        size_t                  m_nPos;         /**< Index of the next symbol */
+        size_t                  m_nCurrent;     /**< Index of the last symbol returned by GetSym */
+        size_t                  m_nTouched;     /**< One past the furthest symbol read or peeked */
+        size_t                  m_nLast;        /**< Index of the terminating T_EOF */
+        LineIndex               m_Lines;
+    };
+}
+
+#endif
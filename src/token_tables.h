@@ -0,0 +1,169 @@
+#ifndef _FLOW_TOKEN_TABLES_H_
+#define _FLOW_TOKEN_TABLES_H_
+
+#include <cstddef>
+
+#include "token.h"
+
+/**
+ * The symbol tables of the tokenizers, shared by the Tokenizer and the StaticTokenizer that 
+ * runs during constant evaluation, so both split a source into the same symbols.
+ */
+namespace flow
+{
+    struct CharToken {
+        char        c;
+        Symbol_t    sym;
+    };
+
+    struct Keyword {
+        const char *    keyword;
+        Symbol_t        sym;
+    };
+
+    /** Single characters tokens */
+    static constexpr CharToken SingleTokens[] = {
+        {';', T_SEMICOLON}, 
+        {':', T_COLON}, 
+        {'.', T_DOT},
+        {'?', T_QUESTION},
+        {',', T_COMMA},
+        {'(', T_LEFT_PAREN}, 
+        {')', T_RIGHT_PAREN}, 
+        {'{', T_LEFT_CURLY_BRACKET}, 
+        {'}', T_RIGHT_CURLY_BRACKET},
+        {'[', T_LEFT_SQUARE_BRACKET}, 
+        {']', T_RIGHT_SQUARE_BRACKET},
+        {'+', T_ADD}, 
+        {'-', T_SUB}, 
+        {'*', T_MUL}, 
+        {'/', T_DIV}
+    };
+
+    /** Keywords */
+    static constexpr Keyword Keywords[] = {
+        {"in", T_KEYWORD_IN}, 
+        {"out", T_KEYWORD_OUT},
+        {"event", T_KEYWORD_EVENT},
+        {"node", T_KEYWORD_NODE},
+        {"query", T_KEYWORD_QUERY},
+        {"float", T_TYPE_FLOAT},
+        {"bool", T_TYPE_BOOL},
+        {"true", T_KEYWORD_TRUE},
+        {"false", T_KEYWORD_FALSE}
+    };
+
+    /** Character classes, a character can belong to several */
+    enum {
+        CC_SPACE        = 1 << 0,
+        CC_DIGIT        = 1 << 1,
+        CC_IDENT_START  = 1 << 2,
+        CC_SINGLE       = 1 << 3,   /**< A single character token, see SingleTokens */
+        CC_IDENT        = 1 << 4    /**< Continues an identifier */
+    };
+
+    struct CharTables {
+        unsigned char   Classes[256];
+        Symbol_t        Single[256];    /**< Only valid for CC_SINGLE characters */
+    };
+
+    static constexpr CharTables MakeCharTables()
+    {
+        CharTables tables = {};
+        for(int c = 0; c < 256; ++c) {
+            unsigned char cls = 0;
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                cls |= CC_SPACE;
+            }
+            if (c >= '0' && c <= '9') {
+                cls |= CC_DIGIT;
+            }
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+                cls |= CC_IDENT_START;
+            }
+            if ((cls & (CC_DIGIT | CC_IDENT_START)) || (c == '_')) {
+                cls |= CC_IDENT;
+            }
+            tables.Classes[c]   = cls;
+            tables.Single[c]    = T_FAILURE;
+        }
+        for(const CharToken & token : SingleTokens) {
+            tables.Classes[static_cast<unsigned char>(token.c)] |= CC_SINGLE;
+            tables.Single[static_cast<unsigned char>(token.c)]  = token.sym;
+        }
+        return tables;
+    }
+
+    static constexpr CharTables CharTable = MakeCharTables();
+
+    /**
+     * Keywords are found through a perfect hash of the length and the first and last 
+     * characters, so only a single candidate is ever compared.
+     */
+    static const size_t KeywordSlotCount = 32;
+
+    struct KeywordSlot {
+        const char *    keyword;
+        size_t          length;     /**< 0 for an empty slot */
+        Symbol_t        sym;
+    };
+
+    static constexpr size_t KeywordHash(char first, char last, size_t length)
+    {
+        return (static_cast<unsigned char>(first) + static_cast<unsigned char>(last) * 6 + length) & (KeywordSlotCount - 1);
+    }
+
+    static constexpr size_t ConstLength(const char * str)
+    {
+        size_t length = 0;
+        while(str[length]) {
+            ++length;
+        }
+        return length;
+    }
+
+    struct KeywordTable {
+        KeywordSlot     Slots[KeywordSlotCount];
+        bool            Perfect;    /**< false if two keywords hash to the same slot */
+    };
+
+    static constexpr KeywordTable MakeKeywordTable()
+    {
+        KeywordTable table = {};
+        table.Perfect = true;
+        for(const Keyword & keyword : Keywords) {
+            size_t length = ConstLength(keyword.keyword);
+            KeywordSlot & slot = table.Slots[KeywordHash(keyword.keyword[0], keyword.keyword[length - 1], length)];
+            if (slot.length != 0) {
+                table.Perfect = false;
+            }
+            slot.keyword    = keyword.keyword;
+            slot.length     = length;
+            slot.sym        = keyword.sym;
+        }
+        return table;
+    }
+
+    static constexpr KeywordTable KeywordSlots = MakeKeywordTable();
+    static_assert(KeywordSlots.Perfect, "Keywords collide in KeywordHash, adjust the hash or KeywordSlotCount");
+
+    /**
+     * Returns the keyword symbol for the identifier, or T_IDENT.
+     */
+    static constexpr Symbol_t MatchKeyword(const char * pStr, size_t length)
+    {
+        const KeywordSlot & slot = KeywordSlots.Slots[KeywordHash(pStr[0], pStr[length - 1], length)];
+        if (slot.length != length) {
+            return T_IDENT;
+        }
+        /** memcmp isn't constexpr, and keywords are short */
+        for(size_t i = 0; i < length; ++i) {
+            if (slot.keyword[i] != pStr[i]) {
+                return T_IDENT;
+            }
+        }
+        return slot.sym;
+    }
+}
+
+#endif
@@ -0,0 +1,73 @@
+#include "batch.h"
+#include "test.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/** A batch gives the same documents and errors as parsing the items one after the other */
+static void TestBatchMatchesSerial(unsigned a_Threads)
+{
+    std::mt19937 random(a_Threads);
+    std::vector<std::string> sources;
+    for(size_t i = 0; i < 300; ++i) {
+        size_t count = random() % 40;
+        /** every tenth document has a syntax error */
+        sources.push_back(flow::test::RandomDocument(random, count, (i % 2) ? "\n" : " ", ((i % 10) == 3) ? random() % (count + 1) : ~size_t(0)));
+    }
+    /** a couple of items are files */
+    std::vector<std::string> paths;
+    for(size_t i = 0; i < 2; ++i) {
+        paths.push_back("batch_test_" + std::to_string(a_Threads) + "_" + std::to_string(i) + ".flow");
+        FILE * file = fopen(paths.back().c_str(), "wb");
+        FLOW_CHECK(file != nullptr);
+        if (file) {
+            fwrite(sources[i].data(), 1, sources[i].size(), file);
+            fclose(file);
+        }
+    }
+
+    std::vector<flow::BatchItem> items;
+    for(size_t i = 0; i < sources.size(); ++i) {
+        items.push_back((i < paths.size()) ? flow::BatchItem(paths[i].c_str()) : flow::BatchItem(sources[i].data(), sources[i].size()));
+    }
+    flow::BatchParser batch(a_Threads);
+    std::vector<flow::BatchResult> results;
+    bool success = batch.ParseBatch(items, results);
+    FLOW_CHECK(results.size() == sources.size());
+
+    bool allParsed = true;
+    for(size_t i = 0; (i < sources.size()) && (i < results.size()); ++i) {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        bool parsed = parser.Parse(sources[i], document);
+        allParsed = allParsed && parsed;
+        FLOW_CHECK(results[i].Success == parsed);
+        if (parsed) {
+            FLOW_CHECK(flow::test::SameDocument(results[i].Document, batch.GetSymbolTable(), document, parser.GetSymbolTable()));
+        } else {
+            FLOW_CHECK(results[i].ErrorString == parser.GetErrorString());
+        }
+    }
+    FLOW_CHECK(success == allParsed);
+
+    /** names are shared by every document of the batch */
+    for(const flow::BatchResult & result : results) {
+        if (result.Success && !result.Document.Nodes.empty()) {
+            const char * name = batch.GetString(result.Document.Nodes[0].NameIndex);
+            FLOW_CHECK(batch.GetSymbolTable().Find(name, strlen(name)) == result.Document.Nodes[0].NameIndex);
+        }
+    }
+    for(const std::string & path : paths) {
+        remove(path.c_str());
+    }
+}
+
+int main()
+{
+    TestBatchMatchesSerial(1);
+    TestBatchMatchesSerial(4);
+    TestBatchMatchesSerial(0);
+    return flow::test::Failures();
+}
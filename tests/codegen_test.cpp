@@ -0,0 +1,42 @@
+#include "codegen.h"
+#include "test.h"
+
+#include <sstream>
+#include <string>
+
+/** Generated by flowgen from codegen_test.flow when the test is built, so it must compile */
+#include "codegen_test.h"
+
+static_assert(static_cast<int>(generated::Player::InEvent::Count) == 2, "in events of Player");
+static_assert(static_cast<int>(generated::Player::OutEvent::Player) == 0, "an event can be named as its node");
+static_assert(static_cast<int>(generated::Count::OutEvent::Count) == 1, "a node can be named Count");
+static_assert(static_cast<int>(generated::Status::OutEvent::Count) == 1, "out events of Status");
+static_assert(sizeof(generated::Player) == 2 * sizeof(float) + sizeof(float), "floats first, then the bool");
+
+int main()
+{
+    generated::Player player;
+    FLOW_CHECK((player.volume == 0.5f) && (player.Count == 3.0f) && !player.looping);
+    generated::Count count;
+    FLOW_CHECK(count.Play);
+
+    /** a definition can't be named as the event enums of its struct */
+    static const char * const Reserved[] = {
+        "node InEvent { in event a; }",
+        "node OutEvent { }",
+        "query OutEvent { out event a; }",
+        "query InEvent { }",
+        "node std { }",
+    };
+    for(const char * source : Reserved) {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        FLOW_CHECK(parser.Parse(source, strlen(source), document));
+        flow::CodeGenerator generator;
+        std::ostringstream header;
+        FLOW_CHECK(!generator.Generate(document, parser.GetSymbolTable(), header));
+        FLOW_CHECK(generator.GetErrorString().rfind("RESERVED NAME ", 0) == 0);
+        FLOW_CHECK(header.str().empty());
+    }
+    return flow::test::Failures();
+}
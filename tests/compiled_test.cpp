@@ -0,0 +1,109 @@
+#include "compiled.h"
+#include "test.h"
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+/** Copies a blob to a buffer with the given distance from 4-byte alignment */
+static const char * Place(std::vector<uint32_t> & a_Buffer, const std::vector<char> & a_Blob, size_t a_Misalignment)
+{
+    a_Buffer.assign(a_Blob.size() / 4 + 2, 0);
+    char * data = reinterpret_cast<char *>(a_Buffer.data()) + a_Misalignment;
+    memcpy(data, a_Blob.data(), a_Blob.size());
+    return data;
+}
+
+/** Reads everything a loaded document refers to, out of range references show up under the sanitizers */
+static size_t Walk(const flow::CompiledDocument & a_Document)
+{
+    size_t length = 0;
+    for(uint32_t i = 0; i < a_Document.NodeCount() + a_Document.QueryCount(); ++i) {
+        const flow::CompiledDefinition & def = a_Document.Node(i);
+        length += strlen(a_Document.GetString(def.Name));
+        for(uint32_t e = def.FirstEvent; e < def.FirstEvent + def.EventCount; ++e) {
+            length += strlen(a_Document.GetString(a_Document.Event(e).Name));
+        }
+        for(uint32_t v = def.FirstVariable; v < def.FirstVariable + def.VariableCount; ++v) {
+            length += strlen(a_Document.GetString(a_Document.Variable(v).Name));
+        }
+    }
+    return length;
+}
+
+/** Loads a blob after overwriting one byte of it, returns the error */
+static std::string Tamper(const std::vector<char> & a_Blob, size_t a_Offset, uint8_t a_Value)
+{
+    std::vector<char> blob(a_Blob);
+    blob[a_Offset] = static_cast<char>(a_Value);
+    flow::CompiledDocument document;
+    if (document.Load(blob.data(), blob.size())) {
+        Walk(document);
+    }
+    return document.GetErrorString();
+}
+
+int main()
+{
+    std::mt19937 random(1);
+    flow::Parser parser;
+    flow::FlowDocument source;
+    FLOW_CHECK(parser.Parse(flow::test::RandomDocument(random, 40), source));
+    std::vector<char> blob;
+    FLOW_CHECK(flow::CompileDocument(source, parser.GetSymbolTable(), blob));
+
+    /** the names come back from the blob's own table */
+    flow::CompiledDocument document;
+    FLOW_CHECK(document.Load(blob.data(), blob.size()));
+    FLOW_CHECK(document.NodeCount() == source.Nodes.size());
+    FLOW_CHECK(document.QueryCount() == source.Queries.size());
+    for(uint32_t i = 0; i < document.NodeCount(); ++i) {
+        FLOW_CHECK(strcmp(document.GetString(document.Node(i).Name), parser.GetSymbolTable().Retrive(source.Nodes[i].NameIndex)) == 0);
+    }
+    size_t names = Walk(document);
+
+    /** a truncated blob is rejected at every length */
+    for(size_t size = 0; size < blob.size(); ++size) {
+        flow::CompiledDocument truncated;
+        FLOW_CHECK(!truncated.Load(blob.data(), size));
+    }
+
+    /** only a 4-byte aligned blob is used in place */
+    for(size_t misalignment = 0; misalignment < 4; ++misalignment) {
+        std::vector<uint32_t> buffer;
+        const char * data = Place(buffer, blob, misalignment);
+        flow::CompiledDocument placed;
+        FLOW_CHECK(placed.Load(data, blob.size()) == (misalignment == 0));
+        FLOW_CHECK((misalignment == 0) ? (Walk(placed) == names) : (placed.GetErrorString() == "INVALID BLOB"));
+    }
+
+    /** flags, directions and booleans only take the values the compiler writes */
+    const flow::CompiledHeader & header = *reinterpret_cast<const flow::CompiledHeader *>(blob.data());
+    bool boolean = false;
+    for(uint32_t i = 0; i < header.VariableCount; ++i) {
+        const flow::CompiledVariable & var = document.Variable(i);
+        size_t offset = header.VariableOffset + i * sizeof(flow::CompiledVariable);
+        FLOW_CHECK(Tamper(blob, offset + offsetof(flow::CompiledVariable, Flags), var.Flags | 0x04) == "CORRUPT VARIABLE");
+        FLOW_CHECK(Tamper(blob, offset + offsetof(flow::CompiledVariable, Flags), var.Flags | 0x80) == "CORRUPT VARIABLE");
+        FLOW_CHECK(Tamper(blob, offset + offsetof(flow::CompiledVariable, Direction), 2) == "CORRUPT VARIABLE");
+        if (var.Type == flow::FlowVariable::TYPE_BOOL) {
+            FLOW_CHECK(Tamper(blob, offset + offsetof(flow::CompiledVariable, DefaultValue), 2) == "CORRUPT VARIABLE");
+            FLOW_CHECK(Tamper(blob, offset + offsetof(flow::CompiledVariable, DefaultValue) + 3, 1) == "CORRUPT VARIABLE");
+            boolean = true;
+        }
+    }
+    FLOW_CHECK((header.VariableCount > 0) && boolean);
+    for(uint32_t i = 0; i < header.EventCount; ++i) {
+        size_t offset = header.EventOffset + i * sizeof(flow::CompiledEvent);
+        FLOW_CHECK(Tamper(blob, offset + offsetof(flow::CompiledEvent, Direction), 2) == "CORRUPT EVENT");
+    }
+
+    /** any other byte either fails to load or leaves every reference in range */
+    for(size_t offset = 0; offset < blob.size(); ++offset) {
+        for(uint8_t value : {uint8_t(0), uint8_t(1), uint8_t(0x7f), uint8_t(0x80), uint8_t(0xff), static_cast<uint8_t>(random())}) {
+            Tamper(blob, offset, value);
+        }
+    }
+    return flow::test::Failures();
+}
@@ -0,0 +1,174 @@
+#include "concurrent_symbol_table.h"
+#include "test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Exposes the index counter */
+class TestTable : public flow::ConcurrentSymbolTable
+{
+public:
+    uint32_t    GetNextIndex() const            {return m_nNextIndex.load();}
+    /** Skips indices as if inserts had failed after taking them */
+    void        SetNextIndex(uint32_t a_Index)  {m_nNextIndex.store(a_Index);}
+};
+
+static std::vector<std::string> MakeNames(size_t a_Count)
+{
+    std::vector<std::string> names;
+    for(size_t i = 0; i < a_Count; ++i) {
+        /** a few long names so the strings span arena chunks */
+        names.push_back(((i % 97) == 0) ? std::string(200 + i % 50, 'x') + std::to_string(i) : "name_" + std::to_string(i));
+    }
+    return names;
+}
+
+/** Every thread interns every name in an order of its own, all must agree on the indices */
+static void TestConcurrentInsert()
+{
+    const size_t count = 50000;
+    const unsigned threadCount = 8;
+    std::vector<std::string> names = MakeNames(count);
+    flow::ConcurrentSymbolTable table;
+    std::vector< std::vector<flow::SymbolTable::SymIndex> > indices(threadCount, std::vector<flow::SymbolTable::SymIndex>(count));
+    std::atomic<int> mismatches(0);
+
+    std::vector<std::thread> threads;
+    for(unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<size_t> order(count);
+            for(size_t i = 0; i < count; ++i) {
+                order[i] = i;
+            }
+            std::shuffle(order.begin(), order.end(), std::mt19937(t));
+            for(size_t i : order) {
+                indices[t][i] = table.Insert(names[i].data(), names[i].size());
+                /** an interned name is found at once and never moves */
+                if (table.Find(names[i].data(), names[i].size()) != indices[t][i]) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for(std::thread & thread : threads) {
+        thread.join();
+    }
+
+    FLOW_CHECK(mismatches == 0);
+    FLOW_CHECK(table.Size() == count);
+    std::vector<bool> seen(count, false);
+    for(size_t i = 0; i < count; ++i) {
+        flow::SymbolTable::SymIndex index = indices[0][i];
+        for(unsigned t = 1; t < threadCount; ++t) {
+            FLOW_CHECK(indices[t][i] == index);
+        }
+        /** the indices are dense */
+        FLOW_CHECK(index < count);
+        if (index < count) {
+            FLOW_CHECK(!seen[index]);
+            seen[index] = true;
+        }
+        FLOW_CHECK(table.Length(index) == names[i].size());
+        FLOW_CHECK(std::string(table.Retrive(index)) == names[i]);
+    }
+    FLOW_CHECK(table.Find("missing", 7) == flow::SymbolTable::InvalidIndex);
+}
+
+/** Lookups run without locking while another thread inserts and grows the table */
+static void TestLookupDuringInsert()
+{
+    const size_t count = 100000;
+    std::vector<std::string> names = MakeNames(count);
+    flow::ConcurrentSymbolTable table;
+    std::vector<flow::SymbolTable::SymIndex> indices(count);
+    std::atomic<size_t> published(0);
+    std::atomic<int> mismatches(0);
+
+    std::vector<std::thread> readers;
+    for(unsigned t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            std::mt19937 random(t);
+            size_t available;
+            while((available = published.load(std::memory_order_acquire)) < count) {
+                if (available == 0) {
+                    continue;
+                }
+                size_t i = random() % available;
+                flow::SymbolTable::SymIndex index = table.Find(names[i].data(), names[i].size());
+                if ((index != indices[i]) || (std::string(table.Retrive(index)) != names[i])) {
+                    ++mismatches;
+                }
+                /** names not inserted yet are never found */
+                if (table.Find(names[count - 1].data(), names[count - 1].size()) != flow::SymbolTable::InvalidIndex) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for(size_t i = 0; i < count - 1; ++i) {
+        indices[i] = table.Insert(names[i].data(), names[i].size());
+        published.store(i + 1, std::memory_order_release);
+    }
+    published.store(count, std::memory_order_release);
+    for(std::thread & reader : readers) {
+        reader.join();
+    }
+    FLOW_CHECK(mismatches == 0);
+    FLOW_CHECK(table.Size() == count - 1);
+}
+
+/** The indices of failed inserts have no string, the block around them reads as empty */
+static void TestMissingEntries()
+{
+    TestTable table;
+    table.SetNextIndex(5);
+    FLOW_CHECK(table.Insert("a", 1) == 5);
+    for(flow::SymbolTable::SymIndex i = 0; i < 5; ++i) {
+        FLOW_CHECK((table.Retrive(i) == nullptr) && (table.Length(i) == 0));
+    }
+    FLOW_CHECK((strcmp(table.Retrive(5), "a") == 0) && (table.Length(5) == 1));
+    FLOW_CHECK(table.Retrive(6) == nullptr);
+    FLOW_CHECK(table.Size() == 1);
+}
+
+/** Once the last index is handed out inserts fail, the counter never wraps to indices in use */
+static void TestIndexLimit()
+{
+    static const uint32_t Limit = flow::SymbolTable::InvalidIndex - 1;
+    TestTable table;
+    FLOW_CHECK(table.Insert("a", 1) == 0);
+    table.SetNextIndex(Limit);
+    std::vector<std::thread> threads;
+    std::atomic<int> inserted(0);
+    for(unsigned t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t]() {
+            for(size_t i = 0; i < 1000; ++i) {
+                std::string name = "name_" + std::to_string(t) + "_" + std::to_string(i);
+                if (table.Insert(name.data(), name.size()) != flow::SymbolTable::InvalidIndex) {
+                    ++inserted;
+                }
+            }
+        });
+    }
+    for(std::thread & thread : threads) {
+        thread.join();
+    }
+    FLOW_CHECK(inserted == 0);
+    FLOW_CHECK(table.GetNextIndex() == Limit);
+    FLOW_CHECK(table.Insert("a", 1) == 0);
+    FLOW_CHECK((table.Find("name_0_0", 8) == flow::SymbolTable::InvalidIndex) && (table.Size() == 1));
+    FLOW_CHECK(strcmp(table.Retrive(0), "a") == 0);
+}
+
+int main()
+{
+    TestConcurrentInsert();
+    TestLookupDuringInsert();
+    TestMissingEntries();
+    TestIndexLimit();
+    return flow::test::Failures();
+}
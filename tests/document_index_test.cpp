@@ -0,0 +1,103 @@
+#include "document_index.h"
+#include "test.h"
+
+#include <random>
+#include <string>
+
+/** Returns true if every name of the document is found at its position by both indices */
+static bool SameLookups(const flow::FlowDocument & a_Document, const flow::DocumentIndex & a_A, const flow::DocumentIndex & a_B)
+{
+    for(uint32_t i = 0; i < a_Document.Nodes.size(); ++i) {
+        const flow::FlowNode & node = a_Document.Nodes[i];
+        if ((a_A.FindNode(node.NameIndex) != i) || (a_B.FindNode(node.NameIndex) != i) || (a_A.FindQuery(node.NameIndex) != flow::DocumentIndex::NotFound)) {
+            return false;
+        }
+        for(uint32_t e = 0; e < node.Events.size(); ++e) {
+            if ((a_A.FindNodeEvent(i, node.Events[e].NameIndex) != e) || (a_B.FindNodeEvent(i, node.Events[e].NameIndex) != e) ||
+                (a_A.FindNodeVariable(i, node.Events[e].NameIndex) != flow::DocumentIndex::NotFound)) {
+                return false;
+            }
+        }
+        for(uint32_t v = 0; v < node.Variables.size(); ++v) {
+            if ((a_A.FindNodeVariable(i, node.Variables[v].NameIndex) != v) || (a_B.FindNodeVariable(i, node.Variables[v].NameIndex) != v)) {
+                return false;
+            }
+        }
+    }
+    for(uint32_t i = 0; i < a_Document.Queries.size(); ++i) {
+        const flow::FlowQuery & query = a_Document.Queries[i];
+        if ((a_A.FindQuery(query.NameIndex) != i) || (a_B.FindQuery(query.NameIndex) != i) || (a_A.FindNode(query.NameIndex) != flow::DocumentIndex::NotFound)) {
+            return false;
+        }
+        for(uint32_t e = 0; e < query.Events.size(); ++e) {
+            if ((a_A.FindQueryEvent(i, query.Events[e].NameIndex) != e) || (a_B.FindQueryEvent(i, query.Events[e].NameIndex) != e)) {
+                return false;
+            }
+        }
+        for(uint32_t v = 0; v < query.Variables.size(); ++v) {
+            if ((a_A.FindQueryVariable(i, query.Variables[v].NameIndex) != v) || (a_B.FindQueryVariable(i, query.Variables[v].NameIndex) != v)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    std::mt19937 random(1);
+
+    /** indexing while parsing finds the same positions as building the index afterwards */
+    for(size_t count : {1, 10, 1000}) {
+        std::string source = flow::test::RandomDocument(random, count);
+        flow::Parser parser;
+        flow::FlowDocument document;
+        flow::DocumentIndex parsed, built;
+        FLOW_CHECK(parser.Parse(source.data(), source.size(), document, parsed));
+        FLOW_CHECK(built.Build(document, parser.GetSymbolTable()));
+        FLOW_CHECK(SameLookups(document, parsed, built));
+    }
+
+    /** definitions already in the document are kept in the index */
+    {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        flow::DocumentIndex parsed, built;
+        std::string first = "node A { in event x; float y; }", second = "query B { out event x; } node C { out event y; }";
+        FLOW_CHECK(parser.Parse(first.data(), first.size(), document));
+        FLOW_CHECK(parser.Parse(second.data(), second.size(), document, parsed));
+        FLOW_CHECK(built.Build(document, parser.GetSymbolTable()));
+        FLOW_CHECK((document.Nodes.size() == 2) && SameLookups(document, parsed, built));
+    }
+
+    /** duplicates are reported as by Build, the parse itself carries on */
+    static const char * const Duplicates[][2] = {
+        {"node A { } query A { }",                  "DUPLICATE DEFINITION A"},
+        {"node A { in event x; float x; }",         "DUPLICATE MEMBER x IN A"},
+        {"query Q { out event x; out event x; }",   "DUPLICATE MEMBER x IN Q"},
+    };
+    for(const auto & duplicate : Duplicates) {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        flow::DocumentIndex parsed, built;
+        std::string source = duplicate[0];
+        FLOW_CHECK(!parser.Parse(source.data(), source.size(), document, parsed));
+        FLOW_CHECK(parser.GetErrorString() == duplicate[1]);
+        FLOW_CHECK(parsed.GetErrorString() == duplicate[1]);
+        FLOW_CHECK(!built.Build(document, parser.GetSymbolTable()));
+        FLOW_CHECK(built.GetErrorString() == duplicate[1]);
+    }
+
+    /** a definition that fails to parse is not left in the index */
+    {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        flow::DocumentIndex parsed;
+        std::string source = "node A { in event x; } node B { in event y; float ; }";
+        FLOW_CHECK(!parser.Parse(source.data(), source.size(), document, parsed));
+        FLOW_CHECK(document.Nodes.size() == 1);
+        FLOW_CHECK(parsed.FindNode(document.Nodes[0].NameIndex) == 0);
+        FLOW_CHECK(parsed.FindNode(parser.GetSymbolTable().Find("B", 1)) == flow::DocumentIndex::NotFound);
+    }
+    return flow::test::Failures();
+}
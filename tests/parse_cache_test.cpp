@@ -0,0 +1,62 @@
+#include "parse_cache.h"
+#include "test.h"
+
+#include <filesystem>
+#include <random>
+#include <string>
+
+/** Exposes the cache's parser */
+class TestCache : public flow::ParseCache
+{
+public:
+    explicit TestCache(const std::string & a_Directory) : flow::ParseCache(a_Directory)
+    {
+    }
+
+    const flow::Parser & GetParser() const  {return m_Parser;}
+};
+
+static bool SameCompiled(const flow::CompiledDocument & a_A, const flow::CompiledDocument & a_B)
+{
+    return (a_A.Size() == a_B.Size()) && (memcmp(a_A.Data(), a_B.Data(), a_A.Size()) == 0);
+}
+
+int main()
+{
+    std::string directory = "parse_cache_test.dir";
+    std::filesystem::remove_all(directory);
+    {
+        TestCache cache(directory);
+        std::mt19937 random(1);
+        std::string source = flow::test::RandomDocument(random, 20);
+
+        flow::CompiledDocument first, second;
+        FLOW_CHECK(cache.Parse(source, first));
+        FLOW_CHECK(cache.Parse(source, second));
+        FLOW_CHECK((cache.Misses() == 1) && (cache.Hits() == 1));
+        FLOW_CHECK(SameCompiled(first, second));
+
+        /** the key covers the length, a longer source is never served a shorter one's entry */
+        FLOW_CHECK(cache.GetCachePath(source.data(), source.size()) != cache.GetCachePath(source.data(), source.size() - 1));
+        flow::CompiledDocument padded;
+        FLOW_CHECK(cache.Parse(source + " ", padded));
+        FLOW_CHECK(cache.Misses() == 2);
+
+        /** the parser forgets the names of every miss, so it doesn't grow with the number of files */
+        size_t names = 0;
+        for(size_t i = 0; i < 50; ++i) {
+            flow::CompiledDocument document;
+            FLOW_CHECK(cache.Parse(flow::test::RandomDocument(random, 20), document));
+            names = std::max(names, cache.GetParser().GetSymbolTable().Size());
+        }
+        FLOW_CHECK(names < 20 * 8);
+
+        flow::CompiledDocument broken;
+        FLOW_CHECK(!cache.Parse(std::string("node A {"), broken));
+        FLOW_CHECK(!cache.GetErrorString().empty());
+        FLOW_CHECK(!cache.ParseFile(nullptr, broken));
+        FLOW_CHECK(cache.GetErrorString() == "FAILED TO OPEN");
+    }
+    std::filesystem::remove_all(directory);
+    return flow::test::Failures();
+}
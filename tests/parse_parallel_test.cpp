@@ -0,0 +1,82 @@
+#include "parser.h"
+#include "test.h"
+
+#include <random>
+#include <string>
+
+/** The same strings at the same indices */
+static bool SameNames(const flow::SymbolTable & a_A, const flow::SymbolTable & a_B)
+{
+    if (a_A.Size() != a_B.Size()) {
+        return false;
+    }
+    for(size_t i = 0; i < a_A.Size(); ++i) {
+        flow::SymbolTable::SymIndex index = static_cast<flow::SymbolTable::SymIndex>(i);
+        if ((a_A.Length(index) != a_B.Length(index)) || (strcmp(a_A.Retrive(index), a_B.Retrive(index)) != 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool SameSpans(const flow::FlowDocument & a_A, const flow::FlowDocument & a_B)
+{
+    if (a_A.Spans.size() != a_B.Spans.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < a_A.Spans.size(); ++i) {
+        const flow::FlowSpan & x = a_A.Spans[i], & y = a_B.Spans[i];
+        if ((x.Begin != y.Begin) || (x.End != y.End) || (x.Index != y.Index) || (x.IsQuery != y.IsQuery)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Parses a source after a_Prefix on several threads and at once, the results must be identical */
+static void CheckParallel(const std::string & a_Prefix, const std::string & a_Source, unsigned a_Threads, bool a_Success)
+{
+    flow::Parser serialParser, parallelParser;
+    flow::FlowDocument serial, parallel;
+    if (!a_Prefix.empty()) {
+        FLOW_CHECK(serialParser.Parse(a_Prefix, serial));
+        FLOW_CHECK(parallelParser.Parse(a_Prefix, parallel));
+    }
+    FLOW_CHECK(serialParser.Parse(a_Source, serial) == a_Success);
+    FLOW_CHECK(parallelParser.ParseParallel(a_Source.data(), a_Source.size(), parallel, a_Threads) == a_Success);
+    FLOW_CHECK(parallelParser.GetErrorString() == serialParser.GetErrorString());
+    FLOW_CHECK(SameNames(parallelParser.GetSymbolTable(), serialParser.GetSymbolTable()));
+    FLOW_CHECK(flow::test::SameDocument(parallel, parallelParser.GetSymbolTable(), serial, serialParser.GetSymbolTable()));
+    FLOW_CHECK(SameSpans(parallel, serial));
+}
+
+int main()
+{
+    /** large enough for several parts of at least 256 KB */
+    std::mt19937 random(1);
+    for(const char * separator : {" ", "\n"}) {
+        std::string source = flow::test::RandomDocument(random, 40000, separator);
+        FLOW_CHECK(source.size() > 8 * 256 * 1024);
+        for(unsigned threads : {0u, 1u, 2u, 4u, 7u}) {
+            CheckParallel("", source, threads, true);
+        }
+        CheckParallel(flow::test::RandomDocument(random, 10, separator), source, 4, true);
+
+        /** an error in any part, the first or a later one, gives the serial error and partial document */
+        for(size_t error : {size_t(5), size_t(20000), size_t(39990)}) {
+            std::string broken = flow::test::RandomDocument(random, 40000, separator, error);
+            CheckParallel("", broken, 4, false);
+        }
+    }
+
+    /** small documents are parsed serially, with the same results */
+    for(size_t count : {size_t(0), size_t(1), size_t(100), size_t(2000)}) {
+        std::string source = flow::test::RandomDocument(random, count);
+        FLOW_CHECK(source.size() < 256 * 1024);
+        CheckParallel("", source, 4, true);
+        if (count > 0) {
+            CheckParallel("", flow::test::RandomDocument(random, count, "\n", count / 2), 4, false);
+        }
+    }
+    return flow::test::Failures();
+}
@@ -0,0 +1,92 @@
+#include "parser.h"
+#include "test.h"
+
+#include <string>
+
+/** Stops the parse at the n-th callback */
+class StoppingHandler : public flow::ParseHandler
+{
+public:
+    explicit StoppingHandler(int a_Stop) : m_nCalls(0), m_nStop(a_Stop)
+    {
+    }
+
+    bool OnNodeBegin(flow::SymbolTable::SymIndex) override      {return Call();}
+    bool OnNodeEnd(flow::SymbolTable::SymIndex) override        {return Call();}
+    bool OnQueryBegin(flow::SymbolTable::SymIndex) override     {return Call();}
+    bool OnQueryEnd(flow::SymbolTable::SymIndex) override       {return Call();}
+    bool OnEvent(const flow::FlowEvent &) override              {return Call();}
+    bool OnVariable(const flow::FlowVariable &) override        {return Call();}
+
+    int m_nCalls;
+
+protected:
+    bool Call()     {return ++m_nCalls != m_nStop;}
+
+    int m_nStop;
+};
+
+int main()
+{
+    /** a default value of the wrong kind fails the parse, even when a semicolon follows */
+    static const char * const Invalid[] = {
+        "node A { float x = true; }",
+        "node A { float x = ; }",
+        "query Q { out float x = false; }",
+        "node A { bool x = 1; }",
+    };
+    for(const char * source : Invalid) {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        FLOW_CHECK(!parser.Parse(std::string(source), document));
+        FLOW_CHECK(parser.GetErrorString().compare(0, 11, "UNEXPECTED ") == 0);
+        FLOW_CHECK(document.Nodes.empty() && document.Queries.empty());
+
+        flow::FlatDocument flat;
+        FLOW_CHECK(!parser.Parse(source, strlen(source), flat));
+
+        StoppingHandler handler(-1);
+        FLOW_CHECK(!parser.Parse(source, strlen(source), handler));
+        FLOW_CHECK(parser.GetErrorString().compare(0, 11, "UNEXPECTED ") == 0);
+    }
+
+    /** every callback can stop the parse, which is reported as such and not as a syntax error */
+    std::string source = "node A { in event x; float y = 1; } query Q { out event z; }";
+    for(int stop = 1; stop <= 7; ++stop) {
+        flow::Parser parser;
+        StoppingHandler handler(stop);
+        FLOW_CHECK(!parser.Parse(source.data(), source.size(), handler));
+        FLOW_CHECK(parser.GetErrorString() == "STOPPED BY HANDLER");
+        FLOW_CHECK(handler.m_nCalls == stop);
+    }
+    {
+        flow::Parser parser;
+        StoppingHandler handler(-1);
+        FLOW_CHECK(parser.Parse(source.data(), source.size(), handler));
+        FLOW_CHECK(handler.m_nCalls == 7);
+
+        /** a syntax error after a stopped parse isn't reported as a stop */
+        std::string broken = "node A { in event ; }";
+        FLOW_CHECK(!parser.Parse(broken.data(), broken.size(), handler));
+        FLOW_CHECK(parser.GetErrorString().compare(0, 9, "EXPECTED ") == 0);
+    }
+
+    /** appending one small document at a time grows the definitions geometrically */
+    {
+        flow::Parser parser;
+        flow::FlowDocument document;
+        flow::FlatDocument flat;
+        size_t grown = 0, flatGrown = 0;
+        for(int i = 0; i < 1024; ++i) {
+            std::string part = "node N" + std::to_string(i) + " { in event e; } query Q" + std::to_string(i) + " { out bool b; }";
+            size_t capacity = document.Nodes.capacity(), flatCapacity = flat.Variables.capacity();
+            FLOW_CHECK(parser.Parse(part.data(), part.size(), document));
+            FLOW_CHECK(parser.Parse(part.data(), part.size(), flat));
+            grown       += (document.Nodes.capacity() != capacity) ? 1 : 0;
+            flatGrown   += (flat.Variables.capacity() != flatCapacity) ? 1 : 0;
+        }
+        FLOW_CHECK((document.Nodes.size() == 1024) && (flat.Variables.size() == 1024));
+        FLOW_CHECK((grown <= 11) && (flatGrown <= 11));
+    }
+    return flow::test::Failures();
+}
@@ -0,0 +1,91 @@
+#include "push_parser.h"
+#include "test.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+static bool SameSpans(const flow::FlowDocument & a_A, const flow::FlowDocument & a_B)
+{
+    if (a_A.Spans.size() != a_B.Spans.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < a_A.Spans.size(); ++i) {
+        const flow::FlowSpan & x = a_A.Spans[i], & y = a_B.Spans[i];
+        if ((x.Begin != y.Begin) || (x.End != y.End) || (x.Index != y.Index) || (x.IsQuery != y.IsQuery)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Feeds a document in chunks of a_Chunk bytes */
+static bool PushParse(const std::string & a_Source, size_t a_Chunk, flow::PushParser & a_Parser)
+{
+    for(size_t i = 0; i < a_Source.size(); i += a_Chunk) {
+        if (!a_Parser.Feed(a_Source.data() + i, std::min(a_Chunk, a_Source.size() - i))) {
+            return false;
+        }
+    }
+    return a_Parser.Finish();
+}
+
+int main()
+{
+    /** the document, spans and errors are the same as when parsing at once, on one line or many */
+    std::mt19937 random(1);
+    for(const char * separator : {" ", "\n", "\t", " \r\n\t"}) {
+        for(size_t error : {size_t(0), size_t(7), size_t(19), ~size_t(0)}) {
+            std::string source = flow::test::RandomDocument(random, 20, separator, error);
+            flow::Parser whole;
+            flow::FlowDocument expected;
+            bool parsed = whole.Parse(source, expected);
+            FLOW_CHECK(parsed == (error == ~size_t(0)));
+
+            for(size_t chunk : {size_t(1), size_t(7), size_t(64), source.size()}) {
+                flow::Parser parser;
+                flow::FlowDocument document;
+                flow::PushParser push(parser, document);
+                FLOW_CHECK(PushParse(source, chunk, push) == parsed);
+                FLOW_CHECK(push.GetErrorString() == whole.GetErrorString());
+                FLOW_CHECK(flow::test::SameDocument(document, parser.GetSymbolTable(), expected, whole.GetSymbolTable()));
+                FLOW_CHECK(SameSpans(document, expected));
+
+                flow::ParseHandler handler;
+                flow::Parser handlerParser;
+                flow::PushParser handlerPush(handlerParser, handler);
+                FLOW_CHECK(PushParse(source, chunk, handlerPush) == parsed);
+                FLOW_CHECK(handlerPush.GetErrorString() == whole.GetErrorString());
+            }
+        }
+    }
+
+    /** only what wasn't parsed is kept, so a document on one line takes linear time and memory */
+    {
+        std::string source;
+        for(size_t i = 0; i < 20000; ++i) {
+            source += "node N" + std::to_string(i) + " { in event e; float f = 1; } ";
+        }
+        source += "node Broken { float ; }";
+        flow::Parser whole;
+        flow::FlowDocument expected;
+        FLOW_CHECK(!whole.Parse(source, expected));
+
+        static const size_t Chunk = 256, Largest = 64;
+        flow::Parser parser;
+        flow::FlowDocument document;
+        flow::PushParser push(parser, document);
+        size_t buffered = 0;
+        bool success = true;
+        for(size_t i = 0; success && (i < source.size()); i += Chunk) {
+            success = push.Feed(source.data() + i, std::min(Chunk, source.size() - i));
+            buffered = std::max(buffered, push.GetBufferedSize());
+        }
+        FLOW_CHECK(!success || !push.Finish());
+        /** at most the incomplete definition, the previous chunk's last definitions and one chunk */
+        FLOW_CHECK(buffered <= 2 * Chunk + Largest);
+        FLOW_CHECK(push.GetErrorString() == whole.GetErrorString());
+        FLOW_CHECK(SameSpans(document, expected));
+    }
+    return flow::test::Failures();
+}
@@ -0,0 +1,213 @@
+#include "parser.h"
+#include "test.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/** Edits one character of a document again and again, every third edit fails to parse */
+static void TestStorage()
+{
+    std::string source = "node A { in event e0; in event e1; in event e2; in event e3; in event e4; in event e5; }";
+    flow::Parser parser;
+    flow::FlowDocument document;
+    FLOW_CHECK(parser.Parse(source, document));
+    FLOW_CHECK(document.Nodes[0].Events.is_arena());
+
+    std::vector<flow::DefinitionChange> changes;
+    size_t position = source.find("e3");
+    for(int i = 0; i < 200000; ++i) {
+        source[position] = "fg@"[i % 3];
+        flow::TextEdit edit = {position, position + 1, position + 1};
+        FLOW_CHECK(parser.Reparse(source.data(), source.size(), edit, document, changes) == (source[position] != '@'));
+    }
+    /** the storage of replaced definitions is reclaimed and failed parses leave nothing behind */
+    FLOW_CHECK(document.Storage.Capacity() <= 64 * 1024);
+    FLOW_CHECK(document.Nodes[0].Events.is_arena() && (document.Nodes[0].Events.size() == 6));
+    FLOW_CHECK(strcmp(parser.GetString(document.Nodes[0].Events[3].NameIndex), "g3") == 0);
+}
+
+/** Definitions with the same name are matched in source order */
+static void TestDuplicateNames()
+{
+    std::string source = "node A { in event x; }\nnode A { in event y; }\nquery A { out event z; }\n";
+    flow::Parser parser;
+    flow::FlowDocument document;
+    FLOW_CHECK(parser.Parse(source, document));
+
+    /** an edit that spans both nodes and changes neither */
+    std::vector<flow::DefinitionChange> changes;
+    source.insert(source.find("x;") + 2, " ");
+    source.insert(source.find("y;"), "  ");
+    flow::TextEdit edit = {source.find("x;"), source.find("y;") - 3, source.find("y;")};
+    FLOW_CHECK(parser.Reparse(source.data(), source.size(), edit, document, changes));
+    FLOW_CHECK(changes.empty());
+
+    /** the second one is modified, the first one is kept */
+    size_t position = source.find("y;");
+    source[position] = 'w';
+    edit.Begin  = source.find("x;");
+    edit.OldEnd = position + 1;
+    edit.NewEnd = position + 1;
+    FLOW_CHECK(parser.Reparse(source.data(), source.size(), edit, document, changes));
+    FLOW_CHECK((changes.size() == 1) && (changes[0].Type == flow::DefinitionChange::DEFINITION_MODIFIED) && 
+        !changes[0].IsQuery && (changes[0].Index == 1));
+}
+
+static bool SameSpans(const std::vector<flow::FlowSpan> & a_A, const std::vector<flow::FlowSpan> & a_B)
+{
+    if (a_A.size() != a_B.size()) {
+        return false;
+    }
+    for(size_t i = 0; i < a_A.size(); ++i) {
+        if ((a_A[i].Begin != a_B[i].Begin) || (a_A[i].End != a_B[i].End) || (a_A[i].Index != a_B[i].Index) || (a_A[i].IsQuery != a_B[i].IsQuery)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** A definition as text, for comparing definitions of documents with different symbol tables */
+template<class Definition>
+static std::string Describe(const Definition & a_Definition, bool a_IsQuery, const flow::Parser & a_Parser)
+{
+    std::string text = std::string(a_IsQuery ? "query " : "node ") + a_Parser.GetString(a_Definition.NameIndex) + " {";
+    for(const flow::FlowEvent & ev : a_Definition.Events) {
+        text += std::string(" ") + ((ev.Direction == flow::FlowEvent::EVENT_IN) ? "in " : "out ") + a_Parser.GetString(ev.NameIndex);
+    }
+    for(const flow::FlowVariable & var : a_Definition.Variables) {
+        text += std::string(" ") + a_Parser.GetString(var.NameIndex) + ":" + std::to_string(var.Type) + std::to_string(var.HasDirection) + 
+            (var.HasDirection ? std::to_string(var.Direction) : "") + std::to_string(var.HasDefaultValue);
+        if (var.HasDefaultValue) {
+            text += (var.Type == flow::FlowVariable::TYPE_FLOAT) ? std::to_string(var.DefaultValue.fValue) : std::to_string(var.DefaultValue.bValue);
+        }
+    }
+    return text + " }";
+}
+
+/**
+ * Checks the changes a reparse reported, every definition that isn't added or modified
+ * must be one of the definitions the document had before.
+ */
+static void CheckChanges(const flow::FlowDocument & a_Before, const flow::FlowDocument & a_After, 
+    const std::vector<flow::DefinitionChange> & a_Changes, const flow::Parser & a_Parser)
+{
+    std::map<std::string, size_t> old;
+    for(const flow::FlowNode & node : a_Before.Nodes) {
+        ++old[Describe(node, false, a_Parser)];
+    }
+    for(const flow::FlowQuery & query : a_Before.Queries) {
+        ++old[Describe(query, true, a_Parser)];
+    }
+    size_t nodes = a_Before.Nodes.size(), queries = a_Before.Queries.size();
+    std::vector<bool> changedNodes(a_After.Nodes.size(), false), changedQueries(a_After.Queries.size(), false);
+    for(const flow::DefinitionChange & change : a_Changes) {
+        if (change.Type == flow::DefinitionChange::DEFINITION_REMOVED) {
+            --(change.IsQuery ? queries : nodes);
+            continue;
+        }
+        if (change.Type == flow::DefinitionChange::DEFINITION_ADDED) {
+            ++(change.IsQuery ? queries : nodes);
+        }
+        std::vector<bool> & changed = change.IsQuery ? changedQueries : changedNodes;
+        FLOW_CHECK(change.Index < changed.size());
+        if (change.Index < changed.size()) {
+            FLOW_CHECK(!changed[change.Index]);
+            changed[change.Index] = true;
+            FLOW_CHECK(change.NameIndex == (change.IsQuery ? a_After.Queries[change.Index].NameIndex : a_After.Nodes[change.Index].NameIndex));
+        }
+    }
+    FLOW_CHECK((nodes == a_After.Nodes.size()) && (queries == a_After.Queries.size()));
+    for(size_t i = 0; i < a_After.Nodes.size() + a_After.Queries.size(); ++i) {
+        bool isQuery = (i >= a_After.Nodes.size());
+        size_t index = isQuery ? i - a_After.Nodes.size() : i;
+        if (!(isQuery ? changedQueries : changedNodes)[index]) {
+            std::string text = isQuery ? Describe(a_After.Queries[index], true, a_Parser) : Describe(a_After.Nodes[index], false, a_Parser);
+            FLOW_CHECK(old[text] > 0);
+            --old[text];
+        }
+    }
+}
+
+/** Reparses random edits and compares the documents with a full parse of the edited text */
+static void TestRandomEdits()
+{
+    static const char * const Snippets[] = {
+        "", " ", "\n", "x", "node", "query", "{", "}", ";", "@", "1.5", "float", "in event k;", "out bool b = true;",
+        "node Z { in event q; }", "query Z { out event q; }", "} node Y {", "node Y { float f = 2; }\nquery X { out float f; }",
+    };
+    std::mt19937 random(21);
+    size_t succeeded = 0, failed = 0;
+    for(int round = 0; round < 40; ++round) {
+        std::string source = flow::test::RandomDocument(random, 1 + random() % 20, (round % 2) ? " " : "\n");
+        flow::Parser parser;
+        flow::FlowDocument document;
+        FLOW_CHECK(parser.Parse(source, document));
+
+        for(int step = 0; step < 100; ++step) {
+            const std::vector<flow::FlowSpan> & spans = document.Spans;
+            size_t begin = 0, end = 0;
+            std::string text;
+            switch(random() % 4) {
+            case 0:     /** a whole definition at the start or end of another one */
+                if (!spans.empty()) {
+                    const flow::FlowSpan & span = spans[random() % spans.size()];
+                    begin = (random() % 2) ? span.Begin : span.End;
+                } else {
+                    begin = (random() % 2) ? source.size() : 0;
+                }
+                end     = begin;
+                text    = flow::test::RandomDocument(random, 1, " ");
+                text    = (random() % 2) ? (" " + text) : (text + " ");
+                break;
+            case 1:     /** definitions removed, or replaced with other ones */
+                if (!spans.empty()) {
+                    size_t first = random() % spans.size(), last = first + random() % (spans.size() - first);
+                    begin   = spans[first].Begin;
+                    end     = spans[last].End;
+                    text    = (random() % 2) ? "" : flow::test::RandomDocument(random, 1 + random() % 3, "\n");
+                }
+                break;
+            default:    /** anything anywhere */
+                begin   = random() % (source.size() + 1);
+                end     = begin + random() % std::min<size_t>(source.size() - begin + 1, (random() % 4) ? 8 : 200);
+                text    = Snippets[random() % (sizeof(Snippets) / sizeof(Snippets[0]))];
+                break;
+            }
+
+            std::string edited = source.substr(0, begin) + text + source.substr(end);
+            flow::TextEdit edit = {begin, end, begin + text.size()};
+            flow::FlowDocument before = document;
+            std::vector<flow::DefinitionChange> changes;
+            bool reparsed = parser.Reparse(edited.data(), edited.size(), edit, document, changes);
+
+            flow::Parser full;
+            flow::FlowDocument expected;
+            FLOW_CHECK(reparsed == full.Parse(edited, expected));
+            if (reparsed) {
+                FLOW_CHECK(flow::test::SameDocument(document, parser.GetSymbolTable(), expected, full.GetSymbolTable()));
+                FLOW_CHECK(SameSpans(document.Spans, expected.Spans));
+                CheckChanges(before, document, changes, parser);
+                source = edited;
+                ++succeeded;
+            } else {
+                /** the error is the one a full parse finds, and the document is left as it was */
+                FLOW_CHECK(parser.GetErrorString() == full.GetErrorString());
+                FLOW_CHECK(flow::test::SameDocument(document, parser.GetSymbolTable(), before, parser.GetSymbolTable()));
+                FLOW_CHECK(SameSpans(document.Spans, before.Spans));
+                ++failed;
+            }
+        }
+    }
+    FLOW_CHECK((succeeded > 1000) && (failed > 500));
+}
+
+int main()
+{
+    TestStorage();
+    TestDuplicateNames();
+    TestRandomEdits();
+    return flow::test::Failures();
+}
@@ -0,0 +1,123 @@
+#include "parser.h"
+#include "test.h"
+
+#include <string>
+
+/** Exposes the memory a parser keeps across Reset() */
+class TestParser : public flow::Parser
+{
+public:
+    size_t MemoryUsage() const  {return m_SymbolTable.MemoryUsage() + m_Tokens.MemoryUsage() + m_Scratch.Capacity();}
+};
+
+/** Exposes the generation stamp of the slots */
+class TestSymbolTable : public flow::SymbolTable
+{
+public:
+    uint32_t    GetBase() const             {return m_nBase;}
+    /** Only valid on a table whose slots are all below a_Base */
+    void        SetBase(uint32_t a_Base)    {m_nBase = a_Base;}
+};
+
+/** Interns a_Count names with the given prefix, they must get the indices from 0 on */
+static bool InsertNames(flow::SymbolTable & a_Table, const std::string & a_Prefix, size_t a_Count)
+{
+    bool success = true;
+    for(size_t i = 0; i < a_Count; ++i) {
+        std::string name = a_Prefix + std::to_string(i);
+        success &= (a_Table.Insert(name.c_str()) == i) && (a_Table.Find(name.data(), name.size()) == i);
+    }
+    return success && (a_Table.Size() == a_Count);
+}
+
+/** None of the names with the given prefix resolve */
+static bool Forgotten(const flow::SymbolTable & a_Table, const std::string & a_Prefix, size_t a_Count)
+{
+    bool success = true;
+    for(size_t i = 0; i < a_Count; ++i) {
+        std::string name = a_Prefix + std::to_string(i);
+        success &= (a_Table.Find(name.data(), name.size()) == flow::SymbolTable::InvalidIndex);
+    }
+    return success;
+}
+
+int main()
+{
+    /** every generation starts from index 0 in the memory of the previous ones */
+    {
+        TestSymbolTable table;
+        FLOW_CHECK(InsertNames(table, "a", 100));
+        size_t memory = table.MemoryUsage();
+        for(size_t generation = 0; generation < 1000; ++generation) {
+            const char * prefix = (generation % 2) ? "a" : "b";
+            table.Clear(true);
+            FLOW_CHECK((table.Size() == 0) && Forgotten(table, "a", 100) && Forgotten(table, "b", 100));
+            FLOW_CHECK(InsertNames(table, prefix, 100));
+            FLOW_CHECK(Forgotten(table, (generation % 2) ? "b" : "a", 100));
+        }
+        FLOW_CHECK(table.MemoryUsage() == memory);
+        FLOW_CHECK(table.GetBase() == 1000 * 100);
+
+        table.Clear(false);
+        FLOW_CHECK((table.MemoryUsage() == 0) && (table.GetBase() == 0) && Forgotten(table, "a", 100));
+        FLOW_CHECK(InsertNames(table, "a", 100));
+    }
+
+    /** the stamps are rebased before they wrap, without stale slots resolving to the new entries */
+    {
+        static const uint32_t MaxBase = 0x80000000u;
+        TestSymbolTable table;
+        table.SetBase(MaxBase - 50);
+        FLOW_CHECK(InsertNames(table, "a", 40));
+        table.Clear(true);
+        FLOW_CHECK(table.GetBase() == MaxBase - 10);
+        FLOW_CHECK(InsertNames(table, "b", 40) && Forgotten(table, "a", 40));
+        table.Clear(true);
+        FLOW_CHECK(table.GetBase() == 0);
+        FLOW_CHECK(Forgotten(table, "a", 40) && Forgotten(table, "b", 40));
+        FLOW_CHECK(InsertNames(table, "b", 40));
+        for(size_t i = 0; i < 40; ++i) {
+            std::string name = "b" + std::to_string(i);
+            FLOW_CHECK(strcmp(table.Retrive(static_cast<flow::SymbolTable::SymIndex>(i)), name.c_str()) == 0);
+        }
+    }
+
+    /** a reset parser interns the next document from 0 and keeps its memory */
+    {
+        TestParser parser;
+        flow::FlowDocument first;
+        FLOW_CHECK(parser.Parse(std::string("node A { in event x; } query Q { out bool b; }"), first));
+        size_t memory = parser.MemoryUsage();
+        FLOW_CHECK((memory > 0) && (memory <= flow::Parser::MaxRetainedMemory));
+        parser.Reset();
+        FLOW_CHECK(parser.MemoryUsage() == memory);
+        FLOW_CHECK(parser.GetSymbolTable().Find("A", 1) == flow::SymbolTable::InvalidIndex);
+        FLOW_CHECK(parser.GetSymbolTable().Find("x", 1) == flow::SymbolTable::InvalidIndex);
+
+        flow::FlowDocument second;
+        FLOW_CHECK(parser.Parse(std::string("node Z { in event x; }"), second));
+        FLOW_CHECK((second.Nodes[0].NameIndex == 0) && (strcmp(parser.GetString(0), "Z") == 0));
+        FLOW_CHECK((second.Nodes[0].Events[0].NameIndex == 1) && (strcmp(parser.GetString(1), "x") == 0));
+        FLOW_CHECK(parser.GetSymbolTable().Find("Q", 1) == flow::SymbolTable::InvalidIndex);
+    }
+
+    /** a parser that grew past MaxRetainedMemory returns it on reset */
+    {
+        std::string source;
+        for(size_t i = 0; i < 800000; ++i) {
+            source += "node N" + std::to_string(i) + " { in event e" + std::to_string(i) + "; float f = 1; }\n";
+        }
+        TestParser parser;
+        flow::ParseHandler handler;
+        FLOW_CHECK(parser.Parse(source.data(), source.size(), handler));
+        FLOW_CHECK(parser.MemoryUsage() > flow::Parser::MaxRetainedMemory);
+        parser.Reset();
+        FLOW_CHECK(parser.MemoryUsage() == 0);
+        FLOW_CHECK(parser.GetSymbolTable().Find("N0", 2) == flow::SymbolTable::InvalidIndex);
+
+        flow::FlowDocument document;
+        FLOW_CHECK(parser.Parse(std::string("node Z { }"), document));
+        FLOW_CHECK((document.Nodes[0].NameIndex == 0) && (strcmp(parser.GetString(0), "Z") == 0));
+    }
+    return flow::test::Failures();
+}
@@ -0,0 +1,134 @@
+#include "codegen.h"
+#include "runtime.h"
+#include "test.h"
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const char Source[] = "node Relay { in event Input; in event Other; out event Output; float speed = 2; bool on = true; }";
+
+/** Records every dispatched event, an Input is passed on through Output */
+struct Log
+{
+    uint32_t    Input;
+    uint32_t    Output;
+    std::vector< std::pair<uint32_t, uint32_t> > Events;
+};
+
+static void Relay(flow::Runtime & a_Runtime, flow::NodeId a_Node, uint32_t a_InEvent, void * a_UserData)
+{
+    Log & log = *static_cast<Log *>(a_UserData);
+    log.Events.push_back(std::make_pair(a_Node.Index, a_InEvent));
+    if (a_InEvent == log.Input) {
+        a_Runtime.Fire(a_Node, log.Output);
+    }
+}
+
+static uint32_t Symbol(const flow::Parser & a_Parser, const char * a_Name)
+{
+    return a_Parser.GetSymbolTable().Find(a_Name, strlen(a_Name));
+}
+
+int main()
+{
+    flow::Parser parser;
+    flow::FlowDocument document;
+    FLOW_CHECK(parser.Parse(Source, strlen(Source), document));
+    flow::Runtime runtime;
+    FLOW_CHECK(runtime.Load(document, parser.GetSymbolTable()));
+    uint32_t relay = runtime.FindType(Symbol(parser, "Relay"));
+    Log log = {runtime.FindInEvent(relay, Symbol(parser, "Input")), runtime.FindOutEvent(relay, Symbol(parser, "Output")), {}};
+    uint32_t other = runtime.FindInEvent(relay, Symbol(parser, "Other"));
+    FLOW_CHECK((relay == 0) && (log.Input == 0) && (other == 1) && (log.Output == 0));
+    FLOW_CHECK(runtime.FindOutEvent(relay, Symbol(parser, "Input")) == flow::Runtime::NotFound);
+    FLOW_CHECK(runtime.SetHandler(relay, Relay, &log));
+
+    /** events are dispatched in the order they were queued, the ones fired by handlers after */
+    flow::NodeId a, b, c;
+    FLOW_CHECK(runtime.Create(relay, a) && runtime.Create(relay, b) && runtime.Create(relay, c));
+    FLOW_CHECK((runtime.Float(b, 0) == 2.0f) && (runtime.Bool(c, 0) == 1));
+    FLOW_CHECK(runtime.Connect(a, log.Output, b, log.Input));
+    FLOW_CHECK(runtime.Connect(a, log.Output, c, other));
+    FLOW_CHECK(!runtime.Connect(a, 1, b, log.Input) && !runtime.Connect(a, log.Output, b, 2));
+    runtime.Send(a, log.Input);
+    runtime.Send(b, other);
+    runtime.Send(c, log.Input);
+    FLOW_CHECK(runtime.Pending() == 3);
+    FLOW_CHECK(runtime.Run(1) == 1);
+    FLOW_CHECK(runtime.Pending() == 4);
+    FLOW_CHECK(runtime.Run() == 4);
+    FLOW_CHECK(runtime.Pending() == 0);
+    std::vector< std::pair<uint32_t, uint32_t> > expected = {{0, 0}, {1, 1}, {2, 0}, {1, 0}, {2, 1}};
+    FLOW_CHECK(log.Events == expected);
+
+    /** a node created after the connections were compiled has no targets, and can be connected */
+    flow::NodeId d;
+    FLOW_CHECK(runtime.Create(relay, d) && (d.Index == 3));
+    log.Events.clear();
+    runtime.Send(d, log.Input);
+    runtime.Send(a, log.Input);
+    FLOW_CHECK(runtime.Run() == 4);
+    expected = {{3, 0}, {0, 0}, {1, 0}, {2, 1}};
+    FLOW_CHECK(log.Events == expected);
+    FLOW_CHECK(runtime.Connect(d, log.Output, a, other));
+    log.Events.clear();
+    runtime.Send(d, log.Input);
+    FLOW_CHECK(runtime.Run() == 2);
+    expected = {{3, 0}, {0, 1}};
+    FLOW_CHECK(log.Events == expected);
+
+    /** a cycle runs until the limit, the event it stopped at stays queued */
+    runtime.Clear();
+    flow::NodeId x, y;
+    FLOW_CHECK(runtime.Create(relay, x) && runtime.Create(relay, y));
+    FLOW_CHECK(runtime.Connect(x, log.Output, y, log.Input) && runtime.Connect(y, log.Output, x, log.Input));
+    log.Events.clear();
+    runtime.Send(x, log.Input);
+    FLOW_CHECK(runtime.Run(10) == 10);
+    FLOW_CHECK(runtime.Pending() == 1);
+    FLOW_CHECK(runtime.Run(5) == 5);
+    FLOW_CHECK(runtime.Pending() == 1);
+    FLOW_CHECK(log.Events.size() == 15);
+    for(size_t i = 0; i < log.Events.size(); ++i) {
+        FLOW_CHECK(log.Events[i] == std::make_pair(static_cast<uint32_t>(i % 2), log.Input));
+    }
+    runtime.Clear();
+    FLOW_CHECK((runtime.Pending() == 0) && (runtime.Run() == 0) && (runtime.InstanceCount(relay) == 0));
+
+    /** the code generator accepts a document exactly when a runtime can load it */
+    static const char * const Names[] = {
+        "node A { in event speed; out event speed; }",
+        "node A { in event speed; float speed = 1; }",
+        "node A { out event on; bool on; }",
+        "node A { float x; bool x; }",
+        "node A { in event x; in event x; }",
+        "node A { } query A { }",
+        "node A { in event x; out event y; float z; } query B { out event x; out float y; }",
+        "node A { in event B; } node B { out event A; }",
+    };
+    for(const char * source : Names) {
+        flow::Parser names;
+        flow::FlowDocument parsed;
+        FLOW_CHECK(names.Parse(source, strlen(source), parsed));
+        flow::Runtime loaded;
+        flow::CodeGenerator generator;
+        std::ostringstream header;
+        FLOW_CHECK(loaded.Load(parsed, names.GetSymbolTable()) == generator.Generate(parsed, names.GetSymbolTable(), header));
+        FLOW_CHECK(loaded.GetErrorString() == generator.GetErrorString());
+    }
+    std::mt19937 random(1);
+    for(int i = 0; i < 20; ++i) {
+        std::string source = flow::test::RandomDocument(random, 50);
+        flow::Parser names;
+        flow::FlowDocument parsed;
+        FLOW_CHECK(names.Parse(source.data(), source.size(), parsed));
+        flow::Runtime loaded;
+        flow::CodeGenerator generator;
+        std::ostringstream header;
+        FLOW_CHECK(loaded.Load(parsed, names.GetSymbolTable()) && generator.Generate(parsed, names.GetSymbolTable(), header));
+    }
+    return flow::test::Failures();
+}
@@ -0,0 +1,134 @@
+#include "scan.h"
+#include "test.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+/** The characters a scanner skips, it stops at the first one that isn't in the set */
+struct Scanner {
+    const char *    (*Scan)(const char *, const char *);
+    std::string     Run;
+};
+
+/** Results of every scanner and the newline count over [p, end) */
+struct Results {
+    const char *    Stops[4];
+    size_t          Newlines;
+
+    bool operator==(const Results & a_Other) const
+    {
+        for(size_t i = 0; i < 4; ++i) {
+            if (Stops[i] != a_Other.Stops[i]) {
+                return false;
+            }
+        }
+        return Newlines == a_Other.Newlines;
+    }
+};
+
+static const Scanner Scanners[] = {
+    {flow::ScanWhitespace,   " \t\n\r"},
+    {flow::ScanIdentifier,   "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_"},
+    {flow::ScanDigits,       "0123456789"},
+    {flow::ScanBrace,        "abz ;\n\t=()|~\x7f\x80\xc1\xfb\xfd\xff"},
+};
+
+static Results Scan(const char * a_Begin, const char * a_End)
+{
+    Results results;
+    for(size_t i = 0; i < 4; ++i) {
+        results.Stops[i] = Scanners[i].Scan(a_Begin, a_End);
+    }
+    results.Newlines = flow::CountNewlines(a_Begin, a_End);
+    return results;
+}
+
+/** Scans with every kernel the CPU supports, the scalar one is the reference */
+static void CheckKernels(const std::vector<flow::ScanKernel> & a_Kernels, const char * a_Begin, const char * a_End)
+{
+    flow::SetScanKernel(flow::SCAN_SCALAR);
+    Results expected = Scan(a_Begin, a_End);
+    for(flow::ScanKernel kernel : a_Kernels) {
+        flow::SetScanKernel(kernel);
+        if (!(Scan(a_Begin, a_End) == expected)) {
+            fprintf(stderr, "kernel %d differs on %zu bytes\n", static_cast<int>(kernel), static_cast<size_t>(a_End - a_Begin));
+            FLOW_CHECK(false);
+        }
+    }
+}
+
+/** A byte that isn't in a_Run, from the whole range including those with the high bit set */
+static char Stop(std::mt19937 & a_Random, const std::string & a_Run, bool a_Brace)
+{
+    for(;;) {
+        char c = static_cast<char>(a_Random() & 0xff);
+        if (a_Brace ? ((c == '{') || (c == '}')) : (a_Run.find(c) == std::string::npos)) {
+            return c;
+        }
+    }
+}
+
+int main()
+{
+    flow::ScanKernel selected = flow::GetScanKernel();
+    std::vector<flow::ScanKernel> kernels;
+    for(flow::ScanKernel kernel : {flow::SCAN_SCALAR, flow::SCAN_SSE2, flow::SCAN_AVX2}) {
+        if (flow::SetScanKernel(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    FLOW_CHECK(!kernels.empty() && (kernels.front() == flow::SCAN_SCALAR));
+
+    /** runs that end around the vector widths, on a byte stopping them or at the end of the buffer */
+    std::mt19937 random(1);
+    for(const Scanner & scanner : Scanners) {
+        bool brace = (scanner.Scan == flow::ScanBrace);
+        for(size_t length : {0, 1, 2, 15, 16, 17, 31, 32, 33, 47, 48, 63, 64, 65, 100}) {
+            for(size_t offset = 0; offset < 4; ++offset) {
+                for(int ending = 0; ending < 3; ++ending) {
+                    /** exactly sized, so reading past the end is caught by the sanitizers */
+                    size_t tail = (ending == 0) ? 0 : ((ending == 1) ? 1 : 1 + random() % 40);
+                    size_t size = offset + length + tail;
+                    std::unique_ptr<char[]> buffer(new char[size ? size : 1]);
+                    char * begin = buffer.get() + offset;
+                    for(size_t i = 0; i < offset; ++i) {
+                        buffer[i] = static_cast<char>(random() & 0xff);
+                    }
+                    for(size_t i = 0; i < length; ++i) {
+                        begin[i] = scanner.Run[random() % scanner.Run.size()];
+                    }
+                    for(size_t i = length; i < length + tail; ++i) {
+                        begin[i] = (i == length) ? Stop(random, scanner.Run, brace) : static_cast<char>(random() & 0xff);
+                    }
+                    const char * end = begin + length + tail;
+
+                    for(flow::ScanKernel kernel : kernels) {
+                        flow::SetScanKernel(kernel);
+                        FLOW_CHECK(scanner.Scan(begin, end) == begin + length);
+                    }
+                    CheckKernels(kernels, begin, end);
+                }
+            }
+        }
+    }
+
+    /** random text mixing every class, from each position up to each end near it */
+    static const char Alphabet[] = " \t\n\r_09azAZ{}\x80\xff";
+    for(size_t round = 0; round < 200; ++round) {
+        size_t size = random() % 200;
+        std::unique_ptr<char[]> buffer(new char[size ? size : 1]);
+        size_t classes = 1 + random() % (sizeof(Alphabet) - 1);
+        for(size_t i = 0; i < size; ++i) {
+            buffer[i] = (random() % 8 == 0) ? static_cast<char>(random() & 0xff) : Alphabet[random() % classes];
+        }
+        for(size_t begin = 0; begin < size; begin += 1 + random() % 8) {
+            for(size_t end : {size, begin + (size - begin) / 2, size - (size - begin) % 16}) {
+                CheckKernels(kernels, buffer.get() + begin, buffer.get() + end);
+            }
+        }
+    }
+
+    flow::SetScanKernel(selected);
+    return flow::test::Failures();
+}
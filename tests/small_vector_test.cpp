@@ -0,0 +1,129 @@
+#include "parser.h"
+#include "small_vector.h"
+#include "test.h"
+
+#include <random>
+#include <string>
+#include <utility>
+
+static void TestSmallVector()
+{
+    flow::SmallVector<std::string, 2> heap;
+    heap.push_back("a");
+    heap.push_back("b");
+    FLOW_CHECK(heap.is_inline());
+    heap.push_back(heap[0]);
+    FLOW_CHECK(!heap.is_inline() && !heap.is_arena() && (heap.size() == 3) && (heap[2] == "a"));
+
+    flow::Arena arena;
+    flow::SmallVector<int, 2> spilled;
+    for(int i = 0; i < 100; ++i) {
+        spilled.push_back(i, arena);
+    }
+    FLOW_CHECK(spilled.is_arena() && (spilled.size() == 100) && (spilled[99] == 99));
+
+    /** neither a copy nor a move shares the arena, the arena may be reset before they go away */
+    flow::SmallVector<int, 2> copy(spilled);
+    FLOW_CHECK(!copy.is_arena() && (copy.size() == 100) && (copy[50] == 50));
+    flow::SmallVector<int, 2> moved(std::move(spilled));
+    FLOW_CHECK(!moved.is_arena() && !moved.is_inline() && (moved.size() == 100) && (moved[99] == 99) && spilled.empty());
+
+    /** a swap hands the arena buffer over */
+    spilled.swap(moved);
+    FLOW_CHECK(!spilled.is_arena() && (spilled.size() == 100) && moved.empty());
+    for(int i = 0; i < 3; ++i) {
+        moved.push_back(i, arena);
+    }
+    const int * buffer = moved.data();
+    spilled.swap(moved);
+    FLOW_CHECK(spilled.is_arena() && (spilled.data() == buffer) && (spilled.size() == 3) && (moved.size() == 100) && (moved[99] == 99));
+    spilled.swap(copy);
+    FLOW_CHECK(copy.is_arena() && (copy.size() == 3) && !spilled.is_arena() && (spilled.size() == 100));
+    flow::SmallVector<int, 2> small;
+    small.push_back(7);
+    small.swap(copy);
+    FLOW_CHECK(small.is_arena() && (small.size() == 3) && copy.is_inline() && (copy.size() == 1) && (copy[0] == 7));
+
+    /** relocating copies the elements out of memory that is about to go away */
+    flow::Arena other;
+    {
+        flow::Arena temporary;
+        flow::SmallVector<int, 2> local;
+        for(int i = 0; i < 10; ++i) {
+            local.push_back(i, temporary);
+        }
+        local.relocate(other);
+        FLOW_CHECK(local.is_arena());
+        moved.clear();
+        moved.swap(local);
+    }
+    FLOW_CHECK(moved.is_arena() && (moved.size() == 10) && (moved[9] == 9));
+
+    /** growing without an arena moves an arena backed vector to the heap */
+    for(int i = 0; i < 100; ++i) {
+        moved.push_back(i);
+    }
+    FLOW_CHECK(!moved.is_arena() && (moved.size() == 110) && (moved[109] == 99));
+}
+
+/** Spilled members live in the document, and stay valid as long as it does */
+static void TestDocumentStorage()
+{
+    std::mt19937 random(17);
+    std::string source;
+    for(size_t i = 0; i < 200; ++i) {
+        source += "node Wide" + std::to_string(i) + " {";
+        for(size_t j = 0; j < 9; ++j) {
+            source += " in event e" + std::to_string(j) + "; float v" + std::to_string(j) + " = " + std::to_string(j) + ";";
+        }
+        source += " }\n";
+    }
+    source += flow::test::RandomDocument(random, 20000);
+
+    flow::Parser parser;
+    flow::FlowDocument expected;
+    FLOW_CHECK(parser.Parse(source, expected));
+    FLOW_CHECK(expected.Nodes[0].Events.is_arena() && expected.Nodes[0].Variables.is_arena());
+
+    flow::FlowDocument copy;
+    {
+        flow::FlowDocument document;
+        FLOW_CHECK(parser.Parse(source, document));
+        size_t capacity = document.Storage.Capacity();
+        document.Clear();
+        FLOW_CHECK(parser.Parse(source, document));
+        FLOW_CHECK(document.Storage.Capacity() == capacity);
+        copy = document;
+        FLOW_CHECK(!copy.Nodes[0].Events.is_arena());
+    }
+    FLOW_CHECK(flow::test::SameDocument(copy, parser.GetSymbolTable(), expected, parser.GetSymbolTable()));
+
+    /** a definition moved out of a document outlives the document's storage */
+    flow::FlowNode node;
+    {
+        flow::FlowDocument document;
+        FLOW_CHECK(parser.Parse(source, document));
+        FLOW_CHECK(document.Nodes[0].Events.is_arena());
+        node = std::move(document.Nodes[0]);
+        document.Clear();
+        FLOW_CHECK(parser.Parse(flow::test::RandomDocument(random, 5000), document));
+    }
+    FLOW_CHECK(!node.Events.is_arena() && (node.Events.size() == 9) && (node.Variables.size() == 9));
+    for(size_t j = 0; j < 9; ++j) {
+        FLOW_CHECK((node.Events[j].NameIndex == expected.Nodes[0].Events[j].NameIndex) && (node.Variables[j].DefaultValue.fValue == j));
+    }
+
+    /** the parts of a parallel parse are gone once it returns */
+    flow::FlowDocument parallel;
+    FLOW_CHECK(parser.ParseParallel(source.data(), source.size(), parallel, 4));
+    FLOW_CHECK(parallel.Nodes[0].Events.is_arena());
+    flow::FlowDocument moved(std::move(parallel));
+    FLOW_CHECK(flow::test::SameDocument(moved, parser.GetSymbolTable(), expected, parser.GetSymbolTable()));
+}
+
+int main()
+{
+    TestSmallVector();
+    TestDocumentStorage();
+    return flow::test::Failures();
+}
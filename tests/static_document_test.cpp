@@ -0,0 +1,170 @@
+#include "static_document.h"
+#include "test.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+
+static constexpr char Source[] =
+    "node Player { in event Play; in event Stop; out event Playing; bool looping; float volume = 0.5; }\n"
+    "query Status { out event Playing; out bool looping; out float volume; }\n";
+
+FLOW_STATIC_DOCUMENT(StaticSource, Source);
+
+static_assert(StaticSource.GetString(StaticSource.Nodes[0].Name) == "Player", "names are views of the name table");
+static_assert(StaticSource.GetString(StaticSource.Queries[0].Name) == "Status", "names are views of the name table");
+static_assert(StaticSource.GetString(StaticSource.NameCount).empty(), "a symbol outside the table has no name");
+
+/** real literals at the edges of float, each rounded once like std::from_chars does */
+static constexpr char Reals[] =
+    "node Reals {\n"
+    "   float max = 3.4028235e38;\n"
+    "   float below_overflow = 3.4028235677973366e38;\n"
+    "   float min_normal = 1.17549435e-38;\n"
+    "   float below_normal = 1.1754942e-38;\n"
+    "   float denormal = 1e-40;\n"
+    "   float min_denormal = 1.4e-45;\n"
+    "   float above_half_denormal = 7.1e-46;\n"
+    "   float tie_even = 16777217.0;\n"
+    "   float tie_odd = 16777219.0;\n"
+    "   float above_tie = 1.000000059604644775390625000000001;\n"
+    "   float tie = 1.000000059604644775390625;\n"
+    "   float long_digits = 0.1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000001;\n"
+    "   float zero = 0.0e-999;\n"
+    "}\n";
+
+FLOW_STATIC_DOCUMENT(StaticReals, Reals);
+
+static constexpr float RealValues[] = {
+    0x1.fffffep127f, 0x1.fffffep127f, 0x1p-126f, 0x1.fffffcp-127f, 0x1.16c2p-133f, 0x1p-149f, 0x1p-149f,
+    16777216.0f, 16777220.0f, 0x1.000002p0f, 1.0f, 0.1f, 0.0f
+};
+
+constexpr bool SameReals()
+{
+    for(size_t i = 0; i < StaticReals.Variables.size(); ++i) {
+        if (StaticReals.Variables[i].DefaultValue.fValue != RealValues[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(StaticReals.Variables.size() == sizeof(RealValues) / sizeof(RealValues[0]), "a value for every literal");
+static_assert(SameReals(), "real literals are correctly rounded to float");
+static_assert(flow::MeasureStaticDocument("node A { float f = 3.40282357e38; }").Status == flow::GRAMMAR_UNEXPECTED, "rounds to infinity");
+static_assert(flow::MeasureStaticDocument("node A { float f = 7e-46; }").Status == flow::GRAMMAR_UNEXPECTED, "rounds to zero");
+
+/** Parses one real default during constant evaluation or at run time */
+static bool StaticReal(const std::string & a_Literal, float & a_Value)
+{
+    std::string source = "node R { float x = " + a_Literal + "; }";
+    if (flow::MeasureStaticDocument(source).Status != flow::GRAMMAR_OK) {
+        return false;
+    }
+    a_Value = flow::CompileStaticDocument<1, 0, 0, 1, 2, 4>(source).Variables[0].DefaultValue.fValue;
+    return true;
+}
+
+/** Parses one real default with the Parser */
+static bool RuntimeReal(const std::string & a_Literal, float & a_Value)
+{
+    std::string source = "node R { float x = " + a_Literal + "; }";
+    flow::Parser parser;
+    flow::FlatDocument document;
+    if (!parser.Parse(source.data(), source.size(), document)) {
+        return false;
+    }
+    a_Value = document.Variables[0].DefaultValue.fValue;
+    return true;
+}
+
+int main()
+{
+    /** the tables and names match a document parsed at run time */
+    flow::Parser parser;
+    flow::FlatDocument document;
+    FLOW_CHECK(parser.Parse(Source, strlen(Source), document));
+    FLOW_CHECK(StaticSource.NameCount == parser.GetSymbolTable().Size());
+    for(uint32_t i = 0; i < StaticSource.NameCount; ++i) {
+        FLOW_CHECK(StaticSource.GetString(i) == parser.GetString(i));
+    }
+    FLOW_CHECK((document.Nodes.size() == StaticSource.Nodes.size()) && (document.Queries.size() == StaticSource.Queries.size()));
+    FLOW_CHECK((document.Events.size() == StaticSource.Events.size()) && (document.Variables.size() == StaticSource.Variables.size()));
+    for(size_t i = 0; i < document.Nodes.size(); ++i) {
+        FLOW_CHECK(memcmp(&document.Nodes[i], &StaticSource.Nodes[i], sizeof(flow::FlatDefinition)) == 0);
+    }
+    for(size_t i = 0; i < document.Queries.size(); ++i) {
+        FLOW_CHECK(memcmp(&document.Queries[i], &StaticSource.Queries[i], sizeof(flow::FlatDefinition)) == 0);
+    }
+    for(size_t i = 0; i < document.Events.size(); ++i) {
+        FLOW_CHECK(memcmp(&document.Events[i], &StaticSource.Events[i], sizeof(flow::FlatEvent)) == 0);
+    }
+    for(size_t i = 0; i < document.Variables.size(); ++i) {
+        FLOW_CHECK(memcmp(&document.Variables[i], &StaticSource.Variables[i], sizeof(flow::FlatVariable)) == 0);
+    }
+
+    /** real literals round like the Parser's, at the edges and for random digits and exponents */
+    flow::Parser reals;
+    flow::FlatDocument realDocument;
+    FLOW_CHECK(reals.Parse(Reals, strlen(Reals), realDocument));
+    FLOW_CHECK(realDocument.Variables.size() == StaticReals.Variables.size());
+    for(size_t i = 0; i < realDocument.Variables.size(); ++i) {
+        FLOW_CHECK(memcmp(&realDocument.Variables[i], &StaticReals.Variables[i], sizeof(flow::FlatVariable)) == 0);
+    }
+    std::mt19937 digits(7);
+    for(int i = 0; i < 2000; ++i) {
+        std::string literal;
+        for(int n = std::uniform_int_distribution<int>(1, 60)(digits); n > 0; --n) {
+            literal += static_cast<char>('0' + digits() % 10);
+        }
+        literal.insert(std::uniform_int_distribution<size_t>(1, literal.size())(digits), 1, '.');
+        literal += ((literal.back() == '.') ? "0e" : "e") + std::to_string(std::uniform_int_distribution<int>(-70, 45)(digits));
+        float expected = 0, actual = 0;
+        bool parsed = RuntimeReal(literal, expected);
+        FLOW_CHECK(parsed == StaticReal(literal, actual));
+        FLOW_CHECK(!parsed || (memcmp(&expected, &actual, sizeof(float)) == 0));
+    }
+    /** halfway between two floats, printed exactly and to fewer digits */
+    for(int i = 0; i < 2000; ++i) {
+        uint32_t bits = static_cast<uint32_t>(digits() % 0x7f7fffff);
+        float below = 0;
+        memcpy(&below, &bits, sizeof(float));
+        double halfway = (static_cast<double>(below) + static_cast<double>(std::nextafter(below, std::numeric_limits<float>::infinity()))) / 2;
+        for(int precision : {8, 16, 200}) {
+            char literal[256];
+            snprintf(literal, sizeof(literal), "%.*e", precision, halfway);
+            float expected = 0, actual = 0;
+            bool parsed = RuntimeReal(literal, expected);
+            FLOW_CHECK(parsed == StaticReal(literal, actual));
+            FLOW_CHECK(!parsed || (memcmp(&expected, &actual, sizeof(float)) == 0));
+        }
+    }
+
+    /** the compile-time parse runs the same grammar, so it fails where the Parser does */
+    std::mt19937 random(1);
+    for(const char * separator : {" ", "\n", "\t"}) {
+        for(size_t error : {size_t(0), size_t(5), ~size_t(0)}) {
+            std::string source = flow::test::RandomDocument(random, 10, separator, error);
+            source += "node Extra { bool b = 1; }";
+            flow::StaticDocumentSizes sizes = flow::MeasureStaticDocument(source);
+            flow::Parser runtime;
+            flow::FlatDocument parsed;
+            FLOW_CHECK(!runtime.Parse(source.data(), source.size(), parsed));
+
+            std::string message = (sizes.Status == flow::GRAMMAR_EXPECTED) ? 
+                (std::string("EXPECTED ") + flow::Tokenizer::GetTokenString(sizes.Expected) + " at ") :
+                (std::string("UNEXPECTED ") + flow::Tokenizer::GetTokenString(sizes.Actual) + " at ");
+            message += "(Ln: " + std::to_string(sizes.Row) + ", Col: " + std::to_string(sizes.Col) + ")";
+            if (sizes.Status == flow::GRAMMAR_EXPECTED) {
+                message += std::string(", actual ") + flow::Tokenizer::GetTokenString(sizes.Actual);
+            }
+            FLOW_CHECK(sizes.Status != flow::GRAMMAR_OK);
+            FLOW_CHECK(message == runtime.GetErrorString());
+            FLOW_CHECK((sizes.Nodes + sizes.Queries) == (parsed.Nodes.size() + parsed.Queries.size() + 1));
+        }
+    }
+    return flow::test::Failures();
+}
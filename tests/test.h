@@ -0,0 +1,116 @@
+#ifndef _FLOW_TEST_H_
+#define _FLOW_TEST_H_
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "parser.h"
+
+namespace flow
+{
+    namespace test
+    {
+        /** Number of failed checks, returned from main */
+        inline int & Failures()
+        {
+            static int failures = 0;
+            return failures;
+        }
+
+        /**
+         * \brief   Writes a document with a_Count definitions using every part of the grammar.
+         * \param   a_Separator     Written between the tokens of a definition, such as " " or "\n".
+         * \param   a_Error         Breaks the definition at this position, none if it is a_Count or more.
+         */
+        inline std::string RandomDocument(std::mt19937 & a_Random, size_t a_Count, const char * a_Separator = "\n", size_t a_Error = ~size_t(0))
+        {
+            static const char * const Floats[] = {"0", "1", "2.5", "1e3", "0.125f", "3.40282e38", "1.17549435e-38", "123456789"};
+            std::string text;
+            for(size_t i = 0; i < a_Count; ++i) {
+                bool query = (a_Random() % 4) == 0;
+                text += (query ? "query Q" : "node N") + std::to_string(i) + a_Separator + "{" + a_Separator;
+                size_t members = a_Random() % 6;
+                for(size_t m = 0; m < members; ++m) {
+                    /** the names of a definition are unique, the same ones recur across definitions */
+                    std::string name = "m" + std::to_string(a_Random() % 50) + "_" + std::to_string(m);
+                    switch(a_Random() % 5) {
+                    case 0:     text += std::string(query ? "out" : "in") + " event " + name + "_e;"; break;
+                    case 1:     text += "out event " + name + "_o;"; break;
+                    case 2:     text += std::string(query ? "out " : "") + "float " + name + "_f = " + Floats[a_Random() % 8] + ";"; break;
+                    case 3:     text += std::string(query ? "out " : "in ") + "bool " + name + "_b = " + ((a_Random() % 2) ? "true;" : "false;"); break;
+                    default:    text += std::string(query ? "out " : "") + "float " + name + "_u;"; break;
+                    }
+                    text += a_Separator;
+                }
+                text += (i == a_Error) ? "float ;" : "}";
+                text += a_Separator;
+            }
+            return text;
+        }
+
+        /**
+         * \brief   Returns true if two documents have the same definitions with the same names,
+         *          each name looked up in the symbol table of its own document.
+         */
+        template<class NamesA, class NamesB>
+        bool SameDocument(const FlowDocument & a_A, const NamesA & a_NamesA, const FlowDocument & a_B, const NamesB & a_NamesB)
+        {
+            auto sameName = [&](SymbolTable::SymIndex a, SymbolTable::SymIndex b) {
+                return strcmp(a_NamesA.Retrive(a), a_NamesB.Retrive(b)) == 0;
+            };
+            auto sameMembers = [&](const auto & a, const auto & b) {
+                if (!sameName(a.NameIndex, b.NameIndex) || 
+                    (a.Events.size() != b.Events.size()) || (a.Variables.size() != b.Variables.size())) {
+                    return false;
+                }
+                for(size_t i = 0; i < a.Events.size(); ++i) {
+                    if ((a.Events[i].Direction != b.Events[i].Direction) || !sameName(a.Events[i].NameIndex, b.Events[i].NameIndex)) {
+                        return false;
+                    }
+                }
+                for(size_t i = 0; i < a.Variables.size(); ++i) {
+                    const FlowVariable & x = a.Variables[i], & y = b.Variables[i];
+                    if ((x.Type != y.Type) || (x.HasDefaultValue != y.HasDefaultValue) || (x.HasDirection != y.HasDirection) ||
+                        !sameName(x.NameIndex, y.NameIndex)) {
+                        return false;
+                    }
+                    if (x.HasDirection && (x.Direction != y.Direction)) {
+                        return false;
+                    }
+                    if (x.HasDefaultValue && ((x.Type == FlowVariable::TYPE_FLOAT) ? 
+                        (memcmp(&x.DefaultValue.fValue, &y.DefaultValue.fValue, sizeof(float)) != 0) : (x.DefaultValue.bValue != y.DefaultValue.bValue))) {
+                        return false;
+                    }
+                }
+                return true;
+            };
+            if ((a_A.Nodes.size() != a_B.Nodes.size()) || (a_A.Queries.size() != a_B.Queries.size())) {
+                return false;
+            }
+            for(size_t i = 0; i < a_A.Nodes.size(); ++i) {
+                if (!sameMembers(a_A.Nodes[i], a_B.Nodes[i])) {
+                    return false;
+                }
+            }
+            for(size_t i = 0; i < a_A.Queries.size(); ++i) {
+                if (!sameMembers(a_A.Queries[i], a_B.Queries[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
+
+/** Reports a failed check with its location and carries on with the test */
+#define FLOW_CHECK(a_Condition) \
+    do { \
+        if (!(a_Condition)) { \
+            fprintf(stderr, "%s(%d): FAILED %s\n", __FILE__, __LINE__, #a_Condition); \
+            ++flow::test::Failures(); \
+        } \
+    } while(0)
+
+#endif
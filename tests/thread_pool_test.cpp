@@ -0,0 +1,65 @@
+#include "thread_pool.h"
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/** Every index is visited exactly once, by a worker in range */
+static void TestForEach(unsigned a_Threads, size_t a_Count)
+{
+    flow::ThreadPool pool(a_Threads);
+    std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[a_Count + 1]);
+    for(size_t i = 0; i <= a_Count; ++i) {
+        visits[i] = 0;
+    }
+    std::atomic<bool> badWorker(false);
+    for(int round = 0; round < 3; ++round) {
+        pool.ForEach(a_Count, [&](size_t a_Index, unsigned a_Worker) {
+            ++visits[a_Index];
+            if (a_Worker >= pool.Size()) {
+                badWorker = true;
+            }
+        });
+    }
+    for(size_t i = 0; i < a_Count; ++i) {
+        FLOW_CHECK(visits[i] == 3);
+    }
+    FLOW_CHECK(visits[a_Count] == 0);
+    FLOW_CHECK(!badWorker);
+}
+
+/** The first share holds all the expensive items, the other workers have to steal them */
+static void TestStealing()
+{
+    flow::ThreadPool pool(4);
+    if (pool.Size() < 2) {
+        return;
+    }
+    const size_t count = 400;
+    std::vector<unsigned> workers(count);
+    pool.ForEach(count, [&](size_t a_Index, unsigned a_Worker) {
+        workers[a_Index] = a_Worker;
+        if (a_Index < count / pool.Size()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+    size_t stolen = 0;
+    for(size_t i = 0; i < count / pool.Size(); ++i) {
+        stolen += (workers[i] != 0) ? 1 : 0;
+    }
+    FLOW_CHECK(stolen > 0);
+}
+
+int main()
+{
+    TestForEach(1, 1000);
+    TestForEach(4, 0);
+    TestForEach(4, 3);
+    TestForEach(8, 100000);
+    TestForEach(0, 12345);
+    TestStealing();
+    return flow::test::Failures();
+}
@@ -0,0 +1,65 @@
+#include "codegen.h"
+#include "parser.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/**
+ * Generates a C++ header with a struct for every node and query of a flow document.
+ *
+ *  flowgen [-n namespace] input.flow [output.h]
+ *
+ * The header is written to standard output if no output file is given.
+ */
+int main(int argc, char ** argv)
+{
+    const char * input = nullptr, * output = nullptr, * ns = nullptr;
+    for(int i = 1; i < argc; ++i) {
+        if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) {
+            ns = argv[++i];
+        } else if (!input) {
+            input = argv[i];
+        } else if (!output) {
+            output = argv[i];
+        } else {
+            input = nullptr;
+            break;
+        }
+    }
+    if (!input) {
+        std::cerr << "usage: flowgen [-n namespace] input.flow [output.h]" << std::endl;
+        return -1;
+    }
+
+    flow::FlowDocument  document;
+    flow::Parser        parser;
+    if (!parser.ParseFile(input, document)) {
+        std::cerr << input << ": " << parser.GetErrorString() << std::endl;
+        return -1;
+    }
+
+    flow::CodeGenerator generator;
+    generator.SetSourceName(input);
+    if (ns) {
+        generator.SetNamespace(ns);
+    }
+
+    /** the output file is only created for a header that was generated */
+    std::ostringstream header;
+    if (!generator.Generate(document, parser.GetSymbolTable(), header)) {
+        std::cerr << input << ": " << generator.GetErrorString() << std::endl;
+        return -1;
+    }
+    if (output) {
+        std::ofstream stream(output, std::ios::binary);
+        if (!(stream << header.str())) {
+            std::cerr << "FAILED TO WRITE " << output << std::endl;
+            return -1;
+        }
+    } else {
+        std::cout << header.str();
+    }
+    return 0;
+}